@@ -0,0 +1,674 @@
+#include "bench.h"
+#include "raster.h"
+#include "tiles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+
+namespace
+{
+
+constexpr auto PI = 3.14159265f;
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// the winding number of the outline polygons around the given point.
+int winding(const Outline& outline, float x, float y)
+{
+  auto result = 0;
+  size_t first = 0;
+  for (auto count : outline.counts) {
+    for (size_t i = 0; i < count; i++) {
+      auto a = outline.points[first + (i + count - 1) % count];
+      auto b = outline.points[first + i];
+      auto side = (b.x - a.x) * (y - a.y) - (x - a.x) * (b.y - a.y);
+      if (a.y <= y && b.y > y && side > 0.f)
+        result++;
+      else if (a.y > y && b.y <= y && side < 0.f)
+        result--;
+    }
+    first += count;
+  }
+  return result;
+}
+
+// mark the pixels that have edges of the outline passing through them.
+std::vector<bool> edgePixels(const Outline& outline, int size)
+{
+  constexpr auto STEPS_PER_PIXEL = 16;
+
+  std::vector<bool> result(static_cast<size_t>(size) * size, false);
+  size_t first = 0;
+  for (auto count : outline.counts) {
+    for (size_t i = 0; i < count; i++) {
+      auto a = outline.points[first + i];
+      auto b = outline.points[first + (i + 1) % count];
+      auto steps = static_cast<int>(std::ceil(
+        std::max(std::abs(b.x - a.x), std::abs(b.y - a.y)) * STEPS_PER_PIXEL)) + 1;
+      for (auto k = 0; k <= steps; k++) {
+        auto t = static_cast<float>(k) / steps;
+        auto x = static_cast<int>(std::floor(a.x + (b.x - a.x) * t));
+        auto y = static_cast<int>(std::floor(a.y + (b.y - a.y) * t));
+        if (x >= 0 && y >= 0 && x < size && y < size)
+          result[y * size + x] = true;
+      }
+    }
+    first += count;
+  }
+  return result;
+}
+
+// ==========================================================================
+// Compare the rasterized coverage of an outline to a reference image.
+//
+// The reference is built by testing the winding number at 64x64 sample points
+// inside each pixel that has edges passing through it. The other pixels are
+// either fully covered or empty, so a single sample is enough for them.
+//
+// Every pixel must be within a few levels from the reference. The coverage
+// is computed from the sum of the edges in a pixel, which is exact as long as
+// the winding numbers inside the pixel differ by at most one. Only the pixels
+// at the crossings of a self-intersecting fill may break that, so only those
+// are left out of the bound when the fill is known to intersect itself.
+// ==========================================================================
+bool compareCoverage(const char* name, const Outline& outline, FillRule rule,
+  bool selfIntersecting = false)
+{
+  constexpr auto SIZE = 64;
+  constexpr auto SAMPLES = 64;
+  constexpr auto MAX_DIFFERENCE = 2;
+
+  Rasterizer rasterizer(SIZE, SIZE);
+  rasterizer.addOutline(outline);
+  auto mask = rasterizer.rasterize(rule);
+  auto edges = edgePixels(outline, SIZE);
+
+  auto maxDifference = 0;
+  auto maxCrossingDifference = 0;
+  auto crossingCount = 0;
+  for (auto y = 0; y < SIZE; y++) {
+    for (auto x = 0; x < SIZE; x++) {
+      auto samples = edges[y * SIZE + x] ? SAMPLES : 1;
+      auto inside = 0;
+      auto minWinding = INT32_MAX;
+      auto maxWinding = INT32_MIN;
+      for (auto sy = 0; sy < samples; sy++) {
+        for (auto sx = 0; sx < samples; sx++) {
+          auto w = winding(outline, x + (sx + .5f) / samples, y + (sy + .5f) / samples);
+          if (rule == FillRule::NonZero ? w != 0 : (w & 1) != 0)
+            inside++;
+          minWinding = std::min(minWinding, w);
+          maxWinding = std::max(maxWinding, w);
+        }
+      }
+      auto reference = (inside * 255 + samples * samples / 2) / (samples * samples);
+      auto difference = std::abs(reference - mask.at(x, y));
+      if (selfIntersecting && maxWinding - minWinding > 1) {
+        maxCrossingDifference = std::max(maxCrossingDifference, difference);
+        crossingCount++;
+      } else {
+        maxDifference = std::max(maxDifference, difference);
+      }
+    }
+  }
+
+  auto passed = maxDifference <= MAX_DIFFERENCE;
+  printf("  %-18s max difference %3d", name, maxDifference);
+  if (selfIntersecting)
+    printf("  (%d crossing pixels, max %3d)", crossingCount, maxCrossingDifference);
+  printf("  %s\n", passed ? "ok" : "FAILED");
+  return passed;
+}
+
+// ==========================================================================
+// Compare the total coverage of a stroke to its analytic area.
+//
+// The coverage comparison above uses the same outline for the reference, so
+// the stroke geometry itself is checked with shapes that have a known area.
+// ==========================================================================
+bool compareArea(const char* name, const Outline& outline, double expected)
+{
+  constexpr auto SIZE = 64;
+  constexpr auto MAX_RELATIVE_DIFFERENCE = .02;
+
+  Rasterizer rasterizer(SIZE, SIZE);
+  rasterizer.addOutline(outline);
+  auto mask = rasterizer.rasterize(FillRule::NonZero);
+  auto area = 0.;
+  for (auto coverage : mask.coverage)
+    area += coverage / 255.;
+
+  auto passed = std::abs(area - expected) <= expected * MAX_RELATIVE_DIFFERENCE;
+  printf("  %-18s area %8.2f  expected %8.2f  %s\n", name, area, expected,
+    passed ? "ok" : "FAILED");
+  return passed;
+}
+
+// a bitmap of random premultiplied pixels where a quarter is fully opaque.
+Bitmap randomBitmap(int width, int height, unsigned seed)
+{
+  std::mt19937 random(seed);
+  Bitmap bitmap(width, height);
+  for (auto& pixel : bitmap.pixels) {
+    auto a = random() % 4 == 0 ? 255u : random() % 256;
+    auto r = random() % (a + 1);
+    auto g = random() % (a + 1);
+    auto b = random() % (a + 1);
+    pixel = (a << 24) | (r << 16) | (g << 8) | b;
+  }
+  return bitmap;
+}
+
+int maxChannelDifference(const Bitmap& a, const Bitmap& b)
+{
+  auto result = 0;
+  for (size_t i = 0; i < a.pixels.size(); i++) {
+    for (auto shift = 0; shift < 32; shift += 8) {
+      auto ca = static_cast<int>((a.pixels[i] >> shift) & 0xff);
+      auto cb = static_cast<int>((b.pixels[i] >> shift) & 0xff);
+      result = std::max(result, std::abs(ca - cb));
+    }
+  }
+  return result;
+}
+
+// hash the pixels with 64-bit FNV-1a to compare frames without keeping them.
+uint64_t hashPixels(const Bitmap& bitmap)
+{
+  auto hash = 14695981039346656037ull;
+  for (auto pixel : bitmap.pixels) {
+    for (auto shift = 0; shift < 32; shift += 8) {
+      hash ^= (pixel >> shift) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+Path star(Vec2 center, float radius)
+{
+  Path path;
+  for (auto i = 0; i < 5; i++) {
+    auto angle = i * 4.f * PI / 5.f;
+    Vec2 p = { center.x + radius * std::cos(angle), center.y + radius * std::sin(angle) };
+    if (i == 0)
+      path.moveTo(p);
+    else
+      path.lineTo(p);
+  }
+  path.close();
+  return path;
+}
+
+}
+
+// ============================================================================
+
+bool validateRaster()
+{
+  printf("rasterizer coverage compared to 64x64 supersampled images\n");
+  auto passed = true;
+  auto identity = Matrix::identity();
+
+  Path triangle;
+  triangle.moveTo({ 3.3f, 2.1f });
+  triangle.lineTo({ 50.7f, 10.2f });
+  triangle.lineTo({ 20.2f, 45.9f });
+  triangle.close();
+  Outline outline;
+  outline.addFill(triangle, identity);
+  passed &= compareCoverage("triangle", outline, FillRule::NonZero);
+
+  outline.clear();
+  outline.addFill(star({ 32.f, 32.f }, 28.f), identity);
+  passed &= compareCoverage("star (non-zero)", outline, FillRule::NonZero, true);
+  passed &= compareCoverage("star (even-odd)", outline, FillRule::EvenOdd, true);
+
+  Path ellipse;
+  ellipse.addEllipse({ 30.f, 34.f }, 27.5f, 18.3f);
+  outline.clear();
+  outline.addFill(ellipse, Matrix::rotation(30.f, { 30.f, 34.f }));
+  passed &= compareCoverage("rotated ellipse", outline, FillRule::NonZero);
+
+  Path clipped;
+  clipped.moveTo({ -100.f, -50.f });
+  clipped.lineTo({ 300.f, 20.f });
+  clipped.lineTo({ 10.f, 200.f });
+  clipped.close();
+  outline.clear();
+  outline.addFill(clipped, identity);
+  passed &= compareCoverage("clipped triangle", outline, FillRule::NonZero);
+
+  Path rect;
+  rect.addRect(12.f, 12.f, 52.f, 52.f);
+  StrokeStyle style;
+  style.width = 5.f;
+  outline.clear();
+  outline.addStroke(rect, style, Matrix::rotation(17.f, { 32.f, 32.f }));
+  passed &= compareCoverage("rotated stroke", outline, FillRule::NonZero);
+
+  Path polyline;
+  polyline.moveTo({ 8.f, 56.f });
+  polyline.lineTo({ 24.f, 10.f });
+  polyline.lineTo({ 40.f, 50.f });
+  polyline.quadTo({ 60.f, 60.f }, { 56.f, 8.f });
+  style.width = 6.f;
+  style.lineJoin = LineJoin::Round;
+  style.startCap = CapStyle::Square;
+  style.endCap = CapStyle::Round;
+  outline.clear();
+  outline.addStroke(polyline, style, identity);
+  passed &= compareCoverage("round stroke", outline, FillRule::NonZero);
+
+  // the stroked circle of the stress scene and a line with round caps.
+  Path circle;
+  circle.addEllipse({ 32.f, 32.f }, 27.3f, 27.3f);
+  style = StrokeStyle();
+  style.width = 4.f;
+  style.lineJoin = LineJoin::Round;
+  outline.clear();
+  outline.addStroke(circle, style, identity);
+  passed &= compareCoverage("circle stroke", outline, FillRule::NonZero);
+
+  Path line;
+  line.moveTo({ 10.3f, 12.6f });
+  line.lineTo({ 50.8f, 47.1f });
+  style.width = 8.f;
+  style.startCap = CapStyle::Round;
+  style.endCap = CapStyle::Round;
+  outline.clear();
+  outline.addStroke(line, style, identity);
+  passed &= compareCoverage("round caps", outline, FillRule::NonZero);
+
+  Path dot;
+  dot.moveTo({ 31.7f, 32.4f });
+  dot.lineTo({ 31.7f, 32.4f });
+  style.width = 40.f;
+  outline.clear();
+  outline.addStroke(dot, style, identity);
+  passed &= compareCoverage("round dot", outline, FillRule::NonZero);
+
+  printf("stroke coverage compared to analytic areas\n");
+  style = StrokeStyle();
+  style.width = 5.f;
+  outline.clear();
+  outline.addStroke(rect, style, Matrix::rotation(17.f, { 32.f, 32.f }));
+  passed &= compareArea("rotated rectangle", outline, 45. * 45. - 35. * 35.);
+
+  // a figure reversing onto itself is capped by the join at the turn.
+  Path reversal;
+  reversal.moveTo({ 10.f, 32.f });
+  reversal.lineTo({ 40.f, 32.f });
+  reversal.lineTo({ 10.f, 32.f });
+  style.width = 12.f;
+  style.miterLimit = 2.f;
+  outline.clear();
+  outline.addStroke(reversal, style, identity);
+  passed &= compareArea("miter reversal", outline, 30. * 12. + 2. * 6. * 12.);
+  style.lineJoin = LineJoin::Round;
+  outline.clear();
+  outline.addStroke(reversal, style, identity);
+  passed &= compareArea("round reversal", outline, 30. * 12. + PI * 6. * 6. / 2.);
+  style.lineJoin = LineJoin::Bevel;
+  outline.clear();
+  outline.addStroke(reversal, style, identity);
+  passed &= compareArea("bevel reversal", outline, 30. * 12.);
+  style = StrokeStyle();
+  style.width = 40.f;
+  style.startCap = CapStyle::Round;
+  style.endCap = CapStyle::Round;
+  outline.clear();
+  outline.addStroke(dot, style, identity);
+  passed &= compareArea("round dot", outline, PI * 20. * 20.);
+  style.startCap = CapStyle::Square;
+  style.endCap = CapStyle::Square;
+  outline.clear();
+  outline.addStroke(dot, style, identity);
+  passed &= compareArea("square dot", outline, 40. * 40.);
+
+  printf("%s\n", passed ? "all passed" : "some comparisons FAILED");
+  return passed;
+}
+
+// ============================================================================
+// Measure the rasterizer throughput with a wavy polygon of 10 to 100k edges.
+//
+// The polygon covers most of the 800x600 window, so the time includes both the
+// edge accumulation and the resolving of the cells into the coverage mask.
+// ============================================================================
+void benchRaster()
+{
+  printf("rasterizer throughput with an 800x600 polygon\n");
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> noise(0.f, 2.f);
+  Rasterizer rasterizer(800, 600);
+  CoverageMask mask;
+  for (auto edges : { 10, 100, 1000, 10000, 100000 }) {
+    std::vector<Vec2> points;
+    for (auto i = 0; i < edges; i++) {
+      auto angle = 2.f * PI * i / edges;
+      auto radius = 200.f + 20.f * std::sin(angle * 37.f) + noise(random);
+      points.push_back({ 400.f + radius * std::cos(angle), 300.f + .9f * radius * std::sin(angle) });
+    }
+
+    auto iterations = std::max(20, 2000000 / edges);
+    auto start = Clock::now();
+    for (auto k = 0; k < iterations; k++) {
+      for (auto i = 0; i < edges; i++)
+        rasterizer.addLine(points[i], points[(i + 1) % edges]);
+      rasterizer.rasterize(FillRule::NonZero, mask);
+    }
+    auto seconds = secondsSince(start) / iterations;
+    printf("  %6d edges  %8.3f ms/path  %6.1f Medges/s\n", edges,
+      seconds * 1e3, edges / seconds / 1e6);
+  }
+}
+
+// ============================================================================
+// Draw the shapes and the bitmaps of the interactive sample.
+//
+// Text and SVG documents are not supported by the CPU renderer, so those are
+// left for Direct2D to be drawn on top of the rendered frame.
+// ============================================================================
+void drawSampleShapes(TileRenderer& renderer, float angle)
+{
+  renderer.clear({ 0.f, 0.f, 0.f, 1.f });
+  renderer.setTransform(Matrix::rotation(angle, { 400.f, 300.f }));
+  renderer.drawRectangle({ 300.f, 200.f, 500.f, 400.f }, { 1.f, 1.f, 1.f, 1.f }, 10.f);
+  renderer.fillRectangle({ 300.f, 200.f, 500.f, 400.f }, { 0.f, 128.f / 255.f, 0.f, 1.f });
+}
+
+// ============================================================================
+
+void drawSampleBitmaps(TileRenderer& renderer, const Bitmap& image,
+  const Bitmap& sheet, int frame)
+{
+  renderer.clear({ 0.f, 0.f, 0.f, 0.f });
+  renderer.setTransform(Matrix::translation(150.f, 100.f));
+  renderer.drawBitmap(image, {
+    0.f, 0.f, static_cast<float>(image.width), static_cast<float>(image.height)
+  });
+
+  // animate spritesheet images with a trivial animation.
+  RectF source = { 5.f + frame * 30.f, 5.f, 30.f + frame * 30.f, 30.f };
+  renderer.setTransform(Matrix::translation(500.f, 500.f));
+  renderer.drawBitmap(sheet, { 0.f, 0.f, 25.f, 25.f }, 1.f,
+    Interpolation::Linear, &source);
+}
+
+// ============================================================================
+
+void drawStressScene(TileRenderer& renderer, const Bitmap& sheet)
+{
+  constexpr auto SHAPES = 3000;
+
+  Path star;
+  for (auto i = 0; i < 5; i++) {
+    auto angle = i * 4.f * PI / 5.f;
+    Vec2 p = { 40.f * std::cos(angle), 40.f * std::sin(angle) };
+    if (i == 0)
+      star.moveTo(p);
+    else
+      star.lineTo(p);
+  }
+  star.close();
+
+  Path circle;
+  circle.addEllipse({ 0.f, 0.f }, 30.f, 30.f);
+  StrokeStyle style;
+  style.width = 4.f;
+  style.lineJoin = LineJoin::Round;
+
+  // the same seed is used for each frame to draw exactly the same frame.
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  RectF cell = { 5.f, 5.f, 30.f, 30.f };
+  renderer.clear({ .1f, .1f, .1f, 1.f });
+  for (auto i = 0; i < SHAPES; i++) {
+    auto x = unit(random) * renderer.width();
+    auto y = unit(random) * renderer.height();
+    auto angle = unit(random) * 360.f;
+    renderer.setTransform(Matrix::rotation(angle, { 0.f, 0.f }) * Matrix::translation(x, y));
+    switch (i % 4) {
+    case 0:
+      renderer.fillPath(star, { unit(random), unit(random), unit(random), .8f }, FillRule::EvenOdd);
+      break;
+    case 1:
+      renderer.drawPath(circle, { unit(random), unit(random), unit(random), 1.f }, style);
+      break;
+    case 2:
+      renderer.drawBitmap(sheet, { -12.f, -12.f, 13.f, 13.f }, .7f);
+      break;
+    case 3:
+      renderer.drawBitmap(sheet, { -32.f, -32.f, 32.f, 32.f }, 1.f,
+        Interpolation::NearestNeighbor, &cell);
+      break;
+    }
+  }
+}
+
+// ============================================================================
+// Measure how the tile renderer scales with the amount of threads.
+//
+// The amount of threads is doubled from one up to all hardware threads, after
+// which the renderer is also run with twice as many threads as there are cores
+// to show the cost of oversubscription. The recording of the commands is done
+// on the calling thread, so it is measured apart from the parallel rendering.
+// Every frame is also compared to the same frame rendered with a single thread
+// through a hash of its pixels, which is computed outside of the measurements.
+// ============================================================================
+void benchTiles(const Bitmap& image, const Bitmap& sheet)
+{
+  auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<unsigned> threadCounts;
+  for (auto threads = 1u; threads < hardware; threads *= 2)
+    threadCounts.push_back(threads);
+  threadCounts.push_back(hardware);
+  threadCounts.push_back(hardware * 2);
+
+  struct Scene
+  {
+    const char* name;
+    int width;
+    int height;
+    int frames;
+    int layers;
+  };
+  const Scene scenes[] = {
+    { "sample scene 800x600", 800, 600, 200, 2 },
+    { "stress scene 1920x1080", 1920, 1080, 10, 1 }
+  };
+
+  printf("tile renderer with %u hardware threads\n", hardware);
+  for (auto s = 0; s < 2; s++) {
+    auto& scene = scenes[s];
+    printf("%s\n", scene.name);
+
+    std::vector<uint64_t> references(scene.frames * scene.layers);
+    Bitmap target;
+    auto singleThreaded = 0.;
+    for (auto threads : threadCounts) {
+      TileRenderer renderer(scene.width, scene.height, threads);
+      auto record = 0.;
+      auto render = 0.;
+      auto identical = true;
+      for (auto k = 0; k < scene.frames; k++) {
+        auto angle = k * .1f;
+        auto frame = k % 4;
+        for (auto layer = 0; layer < scene.layers; layer++) {
+          auto start = Clock::now();
+          renderer.beginDraw();
+          if (s == 1)
+            drawStressScene(renderer, sheet);
+          else if (layer == 0)
+            drawSampleShapes(renderer, angle);
+          else
+            drawSampleBitmaps(renderer, image, sheet, frame);
+          record += secondsSince(start);
+
+          start = Clock::now();
+          renderer.endDraw(target);
+          render += secondsSince(start);
+
+          // the single threaded frames are kept as the reference for the rest.
+          auto& reference = references[k * scene.layers + layer];
+          if (threads == 1)
+            reference = hashPixels(target);
+          identical &= hashPixels(target) == reference;
+        }
+      }
+
+      auto total = (record + render) / scene.frames;
+      if (threads == 1)
+        singleThreaded = total;
+      printf("  %3u threads  %8.3f ms/frame (record %7.3f, render %7.3f)"
+        "  speedup %5.2fx  %s\n", threads, total * 1e3,
+        record / scene.frames * 1e3, render / scene.frames * 1e3,
+        singleThreaded / total, identical ? "identical" : "DIFFERENT");
+    }
+  }
+}
+
+// ============================================================================
+// Compare the bitmap kernels to the reference with random transforms.
+//
+// The cases mix whole pixel translations (the blit kernel), fractional
+// translations and arbitrary affine transforms with random source rectangles,
+// opacities and clip rectangles. The kernels must match the reference exactly.
+// ============================================================================
+bool validateBitmapKernels()
+{
+  constexpr auto CASES = 2000;
+
+  auto source = randomBitmap(128, 96, 3);
+  std::mt19937 random(9);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  int worst[2] = { 0, 0 };
+  for (auto i = 0; i < CASES; i++) {
+    auto target = randomBitmap(97, 83, i);
+    Matrix transform;
+    switch (i % 5) {
+    case 0:
+      transform = Matrix::translation(std::floor(unit(random) * 80.f - 20.f),
+        std::floor(unit(random) * 80.f - 20.f));
+      break;
+    case 1:
+      transform = Matrix::translation(unit(random) * 80.f - 20.f,
+        unit(random) * 80.f - 20.f);
+      break;
+    default:
+      transform = Matrix::rotation(unit(random) * 360.f, { unit(random) * 40.f, unit(random) * 40.f })
+        * Matrix::scale(.3f + unit(random) * 3.f, .3f + unit(random) * 3.f, { 0.f, 0.f })
+        * Matrix::translation(unit(random) * 60.f - 10.f, unit(random) * 60.f - 10.f);
+      break;
+    }
+    auto inverse = transform;
+    inverse.invert();
+    RectF sourceRect = {
+      unit(random) * 40.f - 5.f,
+      unit(random) * 30.f - 5.f,
+      60.f + unit(random) * 80.f,
+      50.f + unit(random) * 60.f
+    };
+    auto opacity = i % 3 == 0 ? 1.f : unit(random);
+    IntRect clip = {
+      static_cast<int>(unit(random) * 10.f),
+      static_cast<int>(unit(random) * 10.f),
+      97 - static_cast<int>(unit(random) * 10.f),
+      83 - static_cast<int>(unit(random) * 10.f)
+    };
+
+    for (auto k = 0; k < 2; k++) {
+      auto interpolation = k == 0 ? Interpolation::NearestNeighbor : Interpolation::Linear;
+      auto kernel = target;
+      auto reference = target;
+      drawBitmap(kernel, clip, source, sourceRect, inverse, opacity, interpolation);
+      drawBitmapReference(reference, clip, source, sourceRect, inverse, opacity, interpolation);
+      worst[k] = std::max(worst[k], maxChannelDifference(kernel, reference));
+    }
+  }
+
+  auto passed = worst[0] == 0 && worst[1] == 0;
+  printf("bitmap kernels compared to the reference in %d random cases\n", CASES);
+  printf("  nearest neighbor  max difference %3d\n", worst[0]);
+  printf("  linear            max difference %3d\n", worst[1]);
+  printf("%s\n", passed ? "all passed" : "some comparisons FAILED");
+  return passed;
+}
+
+// ============================================================================
+// Measure the bitmap kernels and the reference kernel in pixels per second.
+//
+// Both kernels are given the same clip, which is the bounding box of the drawn
+// bitmap, so they visit exactly the same target pixels. The throughput is then
+// counted from the pixels that the bitmap actually covers.
+// ============================================================================
+void benchBitmapKernels()
+{
+  constexpr auto ITERATIONS = 20;
+
+  auto source = randomBitmap(512, 512, 5);
+  auto target = randomBitmap(1024, 1024, 6);
+  RectF sourceRect = { 0.f, 0.f, 512.f, 512.f };
+
+  struct Case
+  {
+    const char* name;
+    Matrix transform;
+    Interpolation interpolation;
+    float opacity;
+  };
+  auto rotation = Matrix::rotation(30.f, { 256.f, 256.f })
+    * Matrix::scale(1.7f, 1.7f, { 256.f, 256.f })
+    * Matrix::translation(256.f, 256.f);
+  auto translation = Matrix::translation(200.f, 200.f);
+  const Case cases[] = {
+    { "blit", translation, Interpolation::Linear, 1.f },
+    { "blit, opacity 0.5", translation, Interpolation::Linear, .5f },
+    { "nearest, rotated", rotation, Interpolation::NearestNeighbor, 1.f },
+    { "nearest, rotated, opacity 0.5", rotation, Interpolation::NearestNeighbor, .5f },
+    { "linear, rotated", rotation, Interpolation::Linear, 1.f },
+    { "linear, rotated, opacity 0.5", rotation, Interpolation::Linear, .5f }
+  };
+
+  printf("bitmap kernels drawing a 512x512 bitmap into a 1024x1024 target\n");
+  IntRect screen = { 0, 0, target.width, target.height };
+  for (auto& c : cases) {
+    auto inverse = c.transform;
+    inverse.invert();
+    auto clip = intersect(enclosingRect(transformBounds(sourceRect, c.transform)), screen);
+
+    // count the covered pixels by drawing an opaque white bitmap.
+    Bitmap white(source.width, source.height);
+    std::fill(white.pixels.begin(), white.pixels.end(), 0xffffffffu);
+    Bitmap probe(target.width, target.height);
+    drawBitmapReference(probe, clip, white, sourceRect, inverse, 1.f, Interpolation::NearestNeighbor);
+    auto pixels = std::count(probe.pixels.begin(), probe.pixels.end(), 0xffffffffu);
+
+    double seconds[2];
+    for (auto k = 0; k < 2; k++) {
+      auto draw = k == 0 ? drawBitmap : drawBitmapReference;
+      auto start = Clock::now();
+      for (auto i = 0; i < ITERATIONS; i++)
+        draw(target, clip, source, sourceRect, inverse, c.opacity, c.interpolation);
+      seconds[k] = secondsSince(start) / ITERATIONS;
+    }
+    printf("  %-30s kernel %7.1f Mpixels/s  reference %6.1f Mpixels/s  %5.1fx\n",
+      c.name, pixels / seconds[0] / 1e6, pixels / seconds[1] / 1e6,
+      seconds[1] / seconds[0]);
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "blit.h"
+
+class TileRenderer;
+
+// ============================================================================
+// Validation and benchmark modes for the CPU renderer.
+//
+// These are run from the command line instead of the interactive sample and
+// they print their results into the standard output. Here's a list of the
+// command line options that select the modes.
+//   --validate-raster...Compare rasterized coverage to reference images and
+//                       the areas of strokes to their analytic areas.
+//   --bench-raster......Measure the rasterizer throughput with 10-100k edges.
+//   --bench-tiles.......Measure the tile renderer with 1 to 2x all threads.
+//   --validate-blit.....Compare the bitmap kernels to the reference kernel.
+//   --bench-blit........Measure the bitmap kernels and the reference kernel.
+//
+// The validation modes return false if any of the results are out of bounds.
+// ============================================================================
+
+bool validateRaster();
+void benchRaster();
+
+// ============================================================================
+// Scenes drawn with the tile renderer.
+//
+// The sample scene contains the shapes and the bitmaps of the interactive
+// sample, which is also drawn with the CPU renderer when the application is
+// started with the --cpu option. Direct2D draws the text and the SVG document
+// between the shapes and the bitmaps, so the scene is split into two layers:
+// the shapes on an opaque background and the bitmaps on a transparent one.
+// The stress scene fills a 1920x1080 frame with thousands of rotated shapes
+// and bitmaps.
+// ============================================================================
+
+void drawSampleShapes(TileRenderer& renderer, float angle);
+void drawSampleBitmaps(TileRenderer& renderer, const Bitmap& image,
+  const Bitmap& sheet, int frame);
+void drawStressScene(TileRenderer& renderer, const Bitmap& sheet);
+
+void benchTiles(const Bitmap& image, const Bitmap& sheet);
+
+bool validateBitmapKernels();
+void benchBitmapKernels();
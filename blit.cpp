@@ -0,0 +1,584 @@
+#include "blit.h"
+
+#include <algorithm>
+#include <cmath>
+
+// use the SSE2 kernels whenever the compiler targets SSE2.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BLIT_SSE2
+#include <emmintrin.h>
+#endif
+
+// ============================================================================
+
+namespace
+{
+
+// multiply two 8-bit values as if they were in the [0, 1] range.
+inline uint32_t mul255(uint32_t a, uint32_t b)
+{
+  auto v = a * b + 128;
+  return (v + (v >> 8)) >> 8;
+}
+
+inline uint32_t channel(uint32_t pixel, int shift)
+{
+  return (pixel >> shift) & 0xff;
+}
+
+// scale all the channels of a premultiplied pixel with an 8-bit factor.
+inline uint32_t scale(uint32_t pixel, uint32_t factor)
+{
+  return mul255(channel(pixel, 0), factor)
+    | mul255(channel(pixel, 8), factor) << 8
+    | mul255(channel(pixel, 16), factor) << 16
+    | mul255(channel(pixel, 24), factor) << 24;
+}
+
+// composite a premultiplied source pixel over the destination pixel.
+inline uint32_t over(uint32_t dst, uint32_t src)
+{
+  auto alpha = src >> 24;
+  if (alpha == 255)
+    return src;
+  if (src == 0)
+    return dst;
+  return src + scale(dst, 255 - alpha);
+}
+
+// ============================================================================
+
+uint32_t sampleNearest(const Bitmap& source, const IntRect& bounds,
+  float u, float v)
+{
+  auto x = static_cast<int>(std::floor(u));
+  auto y = static_cast<int>(std::floor(v));
+  x = std::min(std::max(x, bounds.left), bounds.right - 1);
+  y = std::min(std::max(y, bounds.top), bounds.bottom - 1);
+  return source.row(y)[x];
+}
+
+// ============================================================================
+// Sample a bitmap with a bilinear filter.
+//
+// The filter weights are quantized into 8 bits so that the result can be
+// computed with integers only: each channel is first blended horizontally into
+// a 16-bit value and then vertically with a rounding shift back to 8 bits.
+// ============================================================================
+uint32_t sampleLinear(const Bitmap& source, const IntRect& bounds,
+  float u, float v)
+{
+  u -= .5f;
+  v -= .5f;
+  auto fx = std::floor(u);
+  auto fy = std::floor(v);
+  auto wx = static_cast<uint32_t>((u - fx) * 256.f);
+  auto wy = static_cast<uint32_t>((v - fy) * 256.f);
+  auto x0 = static_cast<int>(fx);
+  auto y0 = static_cast<int>(fy);
+  auto x1 = std::min(std::max(x0 + 1, bounds.left), bounds.right - 1);
+  auto y1 = std::min(std::max(y0 + 1, bounds.top), bounds.bottom - 1);
+  x0 = std::min(std::max(x0, bounds.left), bounds.right - 1);
+  y0 = std::min(std::max(y0, bounds.top), bounds.bottom - 1);
+
+  auto p00 = source.row(y0)[x0];
+  auto p10 = source.row(y0)[x1];
+  auto p01 = source.row(y1)[x0];
+  auto p11 = source.row(y1)[x1];
+
+  uint32_t result = 0;
+  for (auto shift = 0; shift < 32; shift += 8) {
+    auto top = channel(p00, shift) * (256 - wx) + channel(p10, shift) * wx;
+    auto bottom = channel(p01, shift) * (256 - wx) + channel(p11, shift) * wx;
+    auto value = (top * (256 - wy) + bottom * wy + 32768) >> 16;
+    result |= value << shift;
+  }
+  return result;
+}
+
+#ifdef BLIT_SSE2
+
+// ============================================================================
+// SSE2 helpers that work on four pixels at a time.
+//
+// The channels are unpacked into 16-bit lanes for the arithmetic, which keeps
+// every intermediate value of the 8-bit multiplications within the lanes.
+// ============================================================================
+
+inline __m128i mul255(__m128i a, __m128i b)
+{
+  auto v = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+inline __m128i scalePixels(__m128i pixels, __m128i factor)
+{
+  auto zero = _mm_setzero_si128();
+  auto lo = mul255(_mm_unpacklo_epi8(pixels, zero), factor);
+  auto hi = mul255(_mm_unpackhi_epi8(pixels, zero), factor);
+  return _mm_packus_epi16(lo, hi);
+}
+
+// replicate the alpha of each pixel in 16-bit lanes to all of its channels.
+inline __m128i broadcastAlpha(__m128i pixels)
+{
+  pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+inline __m128i overPixels(__m128i dst, __m128i src)
+{
+  auto zero = _mm_setzero_si128();
+  auto max = _mm_set1_epi16(255);
+  auto srcLo = _mm_unpacklo_epi8(src, zero);
+  auto srcHi = _mm_unpackhi_epi8(src, zero);
+  auto lo = mul255(_mm_unpacklo_epi8(dst, zero),
+    _mm_sub_epi16(max, broadcastAlpha(srcLo)));
+  auto hi = mul255(_mm_unpackhi_epi8(dst, zero),
+    _mm_sub_epi16(max, broadcastAlpha(srcHi)));
+  return _mm_add_epi8(_mm_packus_epi16(lo, hi), src);
+}
+
+// select the lanes of a where mask is set and the lanes of b elsewhere.
+inline __m128i selectLanes(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i clamp(__m128i v, int low, int high)
+{
+  auto lo = _mm_set1_epi32(low);
+  auto hi = _mm_set1_epi32(high);
+  v = selectLanes(_mm_cmplt_epi32(v, lo), lo, v);
+  return selectLanes(_mm_cmpgt_epi32(v, hi), hi, v);
+}
+
+inline __m128i floorToInt(__m128 v)
+{
+  auto t = _mm_cvttps_epi32(v);
+  auto greater = _mm_cmpgt_ps(_mm_cvtepi32_ps(t), v);
+  return _mm_add_epi32(t, _mm_castps_si128(greater));
+}
+
+// expand a 32-bit weight per pixel into the 16-bit lanes of pixel pairs.
+inline void expandWeights(__m128i weights, __m128i& lo, __m128i& hi)
+{
+  auto w = _mm_packs_epi32(weights, weights);
+  w = _mm_unpacklo_epi16(w, w);
+  lo = _mm_unpacklo_epi32(w, w);
+  hi = _mm_unpackhi_epi32(w, w);
+}
+
+// interpolate 8-bit values in 16-bit lanes into 16-bit results with 8-bit weights.
+// The weights are passed by reference, because 32-bit MSVC can only pass three
+// vector arguments by value (error C2719).
+inline __m128i lerp(__m128i a, __m128i b, const __m128i& weight,
+  const __m128i& inverse)
+{
+  return _mm_add_epi16(_mm_mullo_epi16(a, inverse), _mm_mullo_epi16(b, weight));
+}
+
+// interpolate the 16-bit results of lerp and round them back into 8 bits. The
+// products need 32 bits, so they are assembled from their low and high halves.
+inline __m128i lerpWide(__m128i a, __m128i b, const __m128i& weight,
+  const __m128i& inverse)
+{
+  auto aLo = _mm_mullo_epi16(a, inverse);
+  auto aHi = _mm_mulhi_epu16(a, inverse);
+  auto bLo = _mm_mullo_epi16(b, weight);
+  auto bHi = _mm_mulhi_epu16(b, weight);
+  auto round = _mm_set1_epi32(32768);
+  auto v0 = _mm_add_epi32(
+    _mm_add_epi32(_mm_unpacklo_epi16(aLo, aHi), _mm_unpacklo_epi16(bLo, bHi)),
+    round);
+  auto v1 = _mm_add_epi32(
+    _mm_add_epi32(_mm_unpackhi_epi16(aLo, aHi), _mm_unpackhi_epi16(bLo, bHi)),
+    round);
+  return _mm_packs_epi32(_mm_srli_epi32(v0, 16), _mm_srli_epi32(v1, 16));
+}
+
+// ============================================================================
+// Sample and blend a single row of target pixels four pixels at a time.
+//
+// The source coordinates are evaluated with the same floating point operations
+// as in the reference, so both select the same source pixels and weights. The
+// pixels outside the source rectangle are zeroed before the blending, which
+// leaves the target untouched. The last pixels of the row are processed via a
+// small buffer so that the row tail goes through the same code path.
+// ============================================================================
+template <bool Linear>
+void sampleRow(Bitmap& target, const IntRect& area, int y,
+  const Bitmap& source, const RectF& sourceRect, const IntRect& bounds,
+  const Matrix& inverse, uint32_t alpha)
+{
+  auto row = target.row(y);
+  auto cy = y + .5f;
+  auto ucy = _mm_set1_ps(inverse.m21 * cy);
+  auto vcy = _mm_set1_ps(inverse.m22 * cy);
+  auto m11 = _mm_set1_ps(inverse.m11);
+  auto m12 = _mm_set1_ps(inverse.m12);
+  auto dx = _mm_set1_ps(inverse.dx);
+  auto dy = _mm_set1_ps(inverse.dy);
+  auto left = _mm_set1_ps(sourceRect.left);
+  auto top = _mm_set1_ps(sourceRect.top);
+  auto right = _mm_set1_ps(sourceRect.right);
+  auto bottom = _mm_set1_ps(sourceRect.bottom);
+  auto half = _mm_set1_ps(.5f);
+  auto lanes = _mm_set_epi32(3, 2, 1, 0);
+  auto alpha16 = _mm_set1_epi16(static_cast<short>(alpha));
+  auto zero = _mm_setzero_si128();
+  auto pixels = source.pixels.data();
+  auto stride = source.width;
+
+  alignas(16) int32_t index[4][4];
+  alignas(16) uint32_t texels[4][4];
+  alignas(16) uint32_t tail[4] = {};
+
+  for (auto x = area.left; x < area.right; x += 4) {
+    auto count = std::min(area.right - x, 4);
+    auto xs = _mm_add_epi32(_mm_set1_epi32(x), lanes);
+    auto cx = _mm_add_ps(_mm_cvtepi32_ps(xs), half);
+    auto u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m11, cx), ucy), dx);
+    auto v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m12, cx), vcy), dy);
+
+    // find the pixels whose centers land inside the source rectangle.
+    auto inside = _mm_and_ps(
+      _mm_and_ps(_mm_cmpge_ps(u, left), _mm_cmplt_ps(u, right)),
+      _mm_and_ps(_mm_cmpge_ps(v, top), _mm_cmplt_ps(v, bottom)));
+    auto mask = _mm_and_si128(_mm_castps_si128(inside),
+      _mm_cmplt_epi32(lanes, _mm_set1_epi32(count)));
+    if (_mm_movemask_epi8(mask) == 0)
+      continue;
+
+    __m128i samples;
+    if (Linear) {
+      u = _mm_sub_ps(u, half);
+      v = _mm_sub_ps(v, half);
+      auto x0 = floorToInt(u);
+      auto y0 = floorToInt(v);
+      auto scale = _mm_set1_ps(256.f);
+      auto wx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(u, _mm_cvtepi32_ps(x0)), scale));
+      auto wy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(v, _mm_cvtepi32_ps(y0)), scale));
+      auto x1 = clamp(_mm_add_epi32(x0, _mm_set1_epi32(1)), bounds.left, bounds.right - 1);
+      auto y1 = clamp(_mm_add_epi32(y0, _mm_set1_epi32(1)), bounds.top, bounds.bottom - 1);
+      x0 = clamp(x0, bounds.left, bounds.right - 1);
+      y0 = clamp(y0, bounds.top, bounds.bottom - 1);
+
+      // gather the four neighbouring pixels for each of the pixels.
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[0]), x0);
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[1]), x1);
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[2]), y0);
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[3]), y1);
+      for (auto i = 0; i < 4; i++) {
+        auto row0 = pixels + static_cast<size_t>(index[2][i]) * stride;
+        auto row1 = pixels + static_cast<size_t>(index[3][i]) * stride;
+        texels[0][i] = row0[index[0][i]];
+        texels[1][i] = row0[index[1][i]];
+        texels[2][i] = row1[index[0][i]];
+        texels[3][i] = row1[index[1][i]];
+      }
+      auto p00 = _mm_load_si128(reinterpret_cast<const __m128i*>(texels[0]));
+      auto p10 = _mm_load_si128(reinterpret_cast<const __m128i*>(texels[1]));
+      auto p01 = _mm_load_si128(reinterpret_cast<const __m128i*>(texels[2]));
+      auto p11 = _mm_load_si128(reinterpret_cast<const __m128i*>(texels[3]));
+
+      __m128i wxLo, wxHi, wyLo, wyHi;
+      expandWeights(wx, wxLo, wxHi);
+      expandWeights(wy, wyLo, wyHi);
+      auto full = _mm_set1_epi16(256);
+      auto iwxLo = _mm_sub_epi16(full, wxLo);
+      auto iwxHi = _mm_sub_epi16(full, wxHi);
+      auto iwyLo = _mm_sub_epi16(full, wyLo);
+      auto iwyHi = _mm_sub_epi16(full, wyHi);
+
+      auto topLo = lerp(_mm_unpacklo_epi8(p00, zero), _mm_unpacklo_epi8(p10, zero), wxLo, iwxLo);
+      auto topHi = lerp(_mm_unpackhi_epi8(p00, zero), _mm_unpackhi_epi8(p10, zero), wxHi, iwxHi);
+      auto botLo = lerp(_mm_unpacklo_epi8(p01, zero), _mm_unpacklo_epi8(p11, zero), wxLo, iwxLo);
+      auto botHi = lerp(_mm_unpackhi_epi8(p01, zero), _mm_unpackhi_epi8(p11, zero), wxHi, iwxHi);
+      auto lo = lerpWide(topLo, botLo, wyLo, iwyLo);
+      auto hi = lerpWide(topHi, botHi, wyHi, iwyHi);
+      if (alpha != 255) {
+        lo = mul255(lo, alpha16);
+        hi = mul255(hi, alpha16);
+      }
+      samples = _mm_packus_epi16(lo, hi);
+    } else {
+      auto sx = clamp(floorToInt(u), bounds.left, bounds.right - 1);
+      auto sy = clamp(floorToInt(v), bounds.top, bounds.bottom - 1);
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[0]), sx);
+      _mm_store_si128(reinterpret_cast<__m128i*>(index[1]), sy);
+      for (auto i = 0; i < 4; i++)
+        texels[0][i] = pixels[static_cast<size_t>(index[1][i]) * stride + index[0][i]];
+      samples = _mm_load_si128(reinterpret_cast<const __m128i*>(texels[0]));
+      if (alpha != 255)
+        samples = scalePixels(samples, alpha16);
+    }
+    samples = _mm_and_si128(samples, mask);
+
+    if (count == 4) {
+      auto dst = reinterpret_cast<__m128i*>(row + x);
+      _mm_storeu_si128(dst, overPixels(_mm_loadu_si128(dst), samples));
+    } else {
+      std::copy(row + x, row + x + count, tail);
+      auto dst = reinterpret_cast<__m128i*>(tail);
+      _mm_store_si128(dst, overPixels(_mm_load_si128(dst), samples));
+      std::copy(tail, tail + count, row + x);
+    }
+  }
+}
+
+#endif
+
+// ============================================================================
+
+IntRect sourceBounds(const Bitmap& source, const RectF& sourceRect)
+{
+  IntRect bounds = {
+    static_cast<int>(std::floor(sourceRect.left)),
+    static_cast<int>(std::floor(sourceRect.top)),
+    static_cast<int>(std::ceil(sourceRect.right)),
+    static_cast<int>(std::ceil(sourceRect.bottom))
+  };
+  return intersect(bounds, { 0, 0, source.width, source.height });
+}
+
+uint32_t opacityToAlpha(float opacity)
+{
+  return static_cast<uint32_t>(std::min(std::max(opacity, 0.f), 1.f) * 255.f + .5f);
+}
+
+// ============================================================================
+// Composite a span of source pixels over the target with a global opacity.
+// ============================================================================
+void blendSpan(uint32_t* dst, const uint32_t* src, int count, uint32_t alpha)
+{
+  auto i = 0;
+  #ifdef BLIT_SSE2
+  auto alpha16 = _mm_set1_epi16(static_cast<short>(alpha));
+  auto opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+  for (; i + 4 <= count; i += 4) {
+    auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (alpha != 255) {
+      s = scalePixels(s, alpha16);
+    } else {
+      // skip the blending when all the four pixels are opaque.
+      auto mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, opaque), opaque));
+      if (mask == 0xffff) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+        continue;
+      }
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, _mm_setzero_si128())) == 0xffff)
+      continue;
+    auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), overPixels(d, s));
+  }
+  #endif
+  for (; i < count; i++) {
+    auto pixel = alpha == 255 ? src[i] : scale(src[i], alpha);
+    dst[i] = over(dst[i], pixel);
+  }
+}
+
+// ============================================================================
+// Draw an axis-aligned and unscaled bitmap as a direct copy of pixel rows.
+//
+// With an integer translation each target pixel center maps exactly onto a
+// source pixel center, so both interpolation modes pick that single pixel and
+// the sampling can be skipped. Returns false if the bitmap can not be drawn
+// this way, e.g. when the source rectangle would need clamping.
+// ============================================================================
+bool blit(Bitmap& target, const IntRect& area, const Bitmap& source,
+  const RectF& sourceRect, const IntRect& bounds, const Matrix& inverse,
+  uint32_t alpha)
+{
+  if (inverse.m11 != 1.f || inverse.m12 != 0.f ||
+      inverse.m21 != 0.f || inverse.m22 != 1.f)
+    return false;
+  if (inverse.dx != std::floor(inverse.dx) || inverse.dy != std::floor(inverse.dy))
+    return false;
+  if (std::abs(inverse.dx) > 1e6f || std::abs(inverse.dy) > 1e6f)
+    return false;
+
+  // find the target pixels whose centers land inside the source rectangle.
+  auto ox = static_cast<int>(inverse.dx);
+  auto oy = static_cast<int>(inverse.dy);
+  auto left = static_cast<int>(std::ceil(sourceRect.left - .5f));
+  auto top = static_cast<int>(std::ceil(sourceRect.top - .5f));
+  auto right = static_cast<int>(std::ceil(sourceRect.right - .5f));
+  auto bottom = static_cast<int>(std::ceil(sourceRect.bottom - .5f));
+  if (left < bounds.left || top < bounds.top ||
+      right > bounds.right || bottom > bounds.bottom)
+    return false;
+
+  auto rect = intersect(area, { left - ox, top - oy, right - ox, bottom - oy });
+  for (auto y = rect.top; y < rect.bottom; y++) {
+    blendSpan(
+      target.row(y) + rect.left,
+      source.row(y + oy) + rect.left + ox,
+      rect.right - rect.left,
+      alpha);
+  }
+  return true;
+}
+
+}
+
+// ============================================================================
+
+Bitmap::Bitmap(int width, int height)
+  : width(width), height(height),
+    pixels(static_cast<size_t>(width) * height, 0)
+{
+}
+
+// ============================================================================
+
+IntRect intersect(const IntRect& a, const IntRect& b)
+{
+  return {
+    std::max(a.left, b.left),
+    std::max(a.top, b.top),
+    std::min(a.right, b.right),
+    std::min(a.bottom, b.bottom)
+  };
+}
+
+IntRect enclosingRect(const RectF& rect)
+{
+  return {
+    static_cast<int>(std::floor(rect.left)),
+    static_cast<int>(std::floor(rect.top)),
+    static_cast<int>(std::floor(rect.right)) + 1,
+    static_cast<int>(std::floor(rect.bottom)) + 1
+  };
+}
+
+RectF transformBounds(const RectF& rect, const Matrix& transform)
+{
+  Vec2 corners[] = {
+    transform.apply({ rect.left, rect.top }),
+    transform.apply({ rect.right, rect.top }),
+    transform.apply({ rect.right, rect.bottom }),
+    transform.apply({ rect.left, rect.bottom })
+  };
+  RectF bounds = { corners[0].x, corners[0].y, corners[0].x, corners[0].y };
+  for (auto& p : corners) {
+    bounds.left = std::min(bounds.left, p.x);
+    bounds.top = std::min(bounds.top, p.y);
+    bounds.right = std::max(bounds.right, p.x);
+    bounds.bottom = std::max(bounds.bottom, p.y);
+  }
+  return bounds;
+}
+
+// ============================================================================
+
+uint32_t premultiply(const Color& color)
+{
+  auto clamp = [](float v) {
+    return static_cast<uint32_t>(std::min(std::max(v, 0.f), 1.f) * 255.f + .5f);
+  };
+  auto a = std::min(std::max(color.a, 0.f), 1.f);
+  return clamp(color.b * a)
+    | clamp(color.g * a) << 8
+    | clamp(color.r * a) << 16
+    | clamp(a) << 24;
+}
+
+void fillRect(Bitmap& target, const IntRect& rect, uint32_t pixel)
+{
+  auto area = intersect(rect, { 0, 0, target.width, target.height });
+  for (auto y = area.top; y < area.bottom; y++) {
+    auto row = target.row(y);
+    std::fill(row + area.left, row + area.right, pixel);
+  }
+}
+
+void blendMask(Bitmap& target, const IntRect& clip, const CoverageMask& mask,
+  int x, int y, uint32_t pixel)
+{
+  IntRect maskRect = {
+    x + mask.x,
+    y + mask.y,
+    x + mask.x + mask.width,
+    y + mask.y + mask.height
+  };
+  auto area = intersect(intersect(clip, maskRect),
+    { 0, 0, target.width, target.height });
+  if (area.empty() || pixel == 0)
+    return;
+
+  for (auto py = area.top; py < area.bottom; py++) {
+    auto row = target.row(py);
+    auto coverage = mask.coverage.data()
+      + static_cast<size_t>(py - maskRect.top) * mask.width;
+    for (auto px = area.left; px < area.right; px++) {
+      auto c = coverage[px - maskRect.left];
+      if (c == 0)
+        continue;
+      row[px] = over(row[px], c == 255 ? pixel : scale(pixel, c));
+    }
+  }
+}
+
+// ============================================================================
+
+void drawBitmap(Bitmap& target, const IntRect& clip, const Bitmap& source,
+  const RectF& sourceRect, const Matrix& inverse, float opacity,
+  Interpolation interpolation)
+{
+  auto area = intersect(clip, { 0, 0, target.width, target.height });
+  auto bounds = sourceBounds(source, sourceRect);
+  auto alpha = opacityToAlpha(opacity);
+  if (area.empty() || bounds.empty() || alpha == 0)
+    return;
+
+  if (blit(target, area, source, sourceRect, bounds, inverse, alpha))
+    return;
+
+  #ifdef BLIT_SSE2
+  for (auto y = area.top; y < area.bottom; y++) {
+    if (interpolation == Interpolation::Linear)
+      sampleRow<true>(target, area, y, source, sourceRect, bounds, inverse, alpha);
+    else
+      sampleRow<false>(target, area, y, source, sourceRect, bounds, inverse, alpha);
+  }
+  #else
+  drawBitmapReference(target, area, source, sourceRect, inverse, opacity,
+    interpolation);
+  #endif
+}
+
+// ============================================================================
+
+void drawBitmapReference(Bitmap& target, const IntRect& clip,
+  const Bitmap& source, const RectF& sourceRect, const Matrix& inverse,
+  float opacity, Interpolation interpolation)
+{
+  auto area = intersect(clip, { 0, 0, target.width, target.height });
+  auto bounds = sourceBounds(source, sourceRect);
+  auto alpha = opacityToAlpha(opacity);
+  if (area.empty() || bounds.empty() || alpha == 0)
+    return;
+
+  for (auto y = area.top; y < area.bottom; y++) {
+    auto row = target.row(y);
+    auto cy = y + .5f;
+    for (auto x = area.left; x < area.right; x++) {
+      auto cx = x + .5f;
+      auto u = inverse.m11 * cx + inverse.m21 * cy + inverse.dx;
+      auto v = inverse.m12 * cx + inverse.m22 * cy + inverse.dy;
+      if (u < sourceRect.left || u >= sourceRect.right ||
+          v < sourceRect.top || v >= sourceRect.bottom)
+        continue;
+
+      auto pixel = interpolation == Interpolation::Linear
+        ? sampleLinear(source, bounds, u, v)
+        : sampleNearest(source, bounds, u, v);
+      if (alpha != 255)
+        pixel = scale(pixel, alpha);
+      row[x] = over(row[x], pixel);
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "raster.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Pixel compositing routines for the CPU renderer.
+//
+// Bitmaps store premultiplied BGRA pixels, which is the same memory layout as
+// DXGI_FORMAT_B8G8R8A8_UNORM and GUID_WICPixelFormat32bppPBGRA, so the pixels
+// can be copied to and from Direct2D and WIC bitmaps without any conversion.
+// Each pixel is handled as a single 32-bit value in the form of 0xAARRGGBB.
+//
+// All drawing is done with the source-over operator, where the destination is
+// covered by the source based on the source alpha.
+//   result = source + destination * (1 - source.alpha)
+// ============================================================================
+
+struct Bitmap
+{
+  int width = 0;
+  int height = 0;
+  std::vector<uint32_t> pixels;
+
+  Bitmap() = default;
+  Bitmap(int width, int height);
+
+  uint32_t* row(int y) { return pixels.data() + static_cast<size_t>(y) * width; }
+  const uint32_t* row(int y) const { return pixels.data() + static_cast<size_t>(y) * width; }
+};
+
+// ============================================================================
+
+// a straight (non-premultiplied) color similar to D2D1_COLOR_F.
+struct Color
+{
+  float r;
+  float g;
+  float b;
+  float a;
+};
+
+// a pixel rectangle where the right and the bottom edges are exclusive.
+struct IntRect
+{
+  int left;
+  int top;
+  int right;
+  int bottom;
+
+  bool empty() const { return left >= right || top >= bottom; }
+};
+
+IntRect intersect(const IntRect& a, const IntRect& b);
+
+// the smallest pixel rectangle containing all pixels touched by the rect.
+IntRect enclosingRect(const RectF& rect);
+
+// the bounding box of a rectangle after it has been transformed.
+RectF transformBounds(const RectF& rect, const Matrix& transform);
+
+// ============================================================================
+
+// Here's a list of the supported bitmap interpolation modes.
+//   Interpolation::NearestNeighbor...Use the color of the closest pixel.
+//   Interpolation::Linear............Blend the four closest pixels.
+enum class Interpolation { NearestNeighbor, Linear };
+
+// convert a straight color into a premultiplied pixel.
+uint32_t premultiply(const Color& color);
+
+// replace the pixels of the rectangle with the given pixel.
+void fillRect(Bitmap& target, const IntRect& rect, uint32_t pixel);
+
+// draw a pixel through a coverage mask that is positioned at (x, y).
+void blendMask(Bitmap& target, const IntRect& clip, const CoverageMask& mask,
+  int x, int y, uint32_t pixel);
+
+// ============================================================================
+// Draw a part of a bitmap with an arbitrary affine transform.
+//
+// The inverse transform maps the target pixel centers into source bitmap space
+// and every target pixel inside the clip, whose center lands inside the source
+// rectangle, is sampled and drawn with the given opacity. Samples are clamped
+// to the source rectangle so that pixels from the neighbouring spritesheet
+// cells never bleed into the drawn cell.
+//
+// The drawing is done with one of the following kernels.
+//   Blit.......Unscaled and axis-aligned bitmaps at whole pixel offsets are
+//              composited directly from the source rows without sampling.
+//   SSE2.......Four pixels at a time with the sampling, the opacity and the
+//              blending fused into a single pass over the target pixels.
+//   Reference..A scalar version that handles a single pixel at a time.
+//
+// The SSE2 kernel is used whenever the compiler targets SSE2. All the kernels
+// use the same fixed point arithmetic and produce exactly the same pixels as
+// the reference, which is kept to validate them.
+// ============================================================================
+void drawBitmap(Bitmap& target, const IntRect& clip, const Bitmap& source,
+  const RectF& sourceRect, const Matrix& inverse, float opacity,
+  Interpolation interpolation);
+
+void drawBitmapReference(Bitmap& target, const IntRect& clip,
+  const Bitmap& source, const RectF& sourceRect, const Matrix& inverse,
+  float opacity, Interpolation interpolation);
@@ -16,8 +16,13 @@
 #include <dwrite.h>
 
 #include <cassert>
+#include <cstring>
+#include <memory>
 #include <string>
 
+#include "bench.h"
+#include "tiles.h"
+
 using namespace Microsoft::WRL;
 
 #pragma comment(lib, "d2d1.lib")
@@ -550,15 +555,15 @@ ComPtr<IWICImagingFactory> createWICFactory()
 }
 
 // ============================================================================
-// Load bitmap with WIC and convert it to Direct2D object.
+// Decode an image with WIC into premultiplied BGRA pixels.
 //
 // Images can be loaded directly by using the WIC API, where the API does have
 // a support for identifying the correct decoder based on the target filename.
 // Decoder is used to load the image data as a frame, which is then converted
-// into a Direct2D compatible image by using the render target object.
+// into the pixel format used by both Direct2D and the CPU renderer bitmaps.
 // ============================================================================
-ComPtr<ID2D1Bitmap> loadBitmap(ComPtr<IWICImagingFactory> factory,
-  D2DContext& d2dCtx, const std::wstring& filename)
+ComPtr<IWICFormatConverter> decodeImage(ComPtr<IWICImagingFactory> factory,
+  const std::wstring& filename)
 {
   assert(factory);
 
@@ -588,10 +593,20 @@ ComPtr<ID2D1Bitmap> loadBitmap(ComPtr<IWICImagingFactory> factory,
     WICBitmapPaletteTypeMedianCut
   ));
 
+  // return the converted image source.
+  return formatConverter;
+}
+
+// ============================================================================
+// Load bitmap with WIC and convert it to Direct2D object.
+// ============================================================================
+ComPtr<ID2D1Bitmap> loadBitmap(ComPtr<IWICImagingFactory> factory,
+  D2DContext& d2dCtx, const std::wstring& filename)
+{
   // create a Direct2D bitmap from the WIC image source.
   ComPtr<ID2D1Bitmap> bitmap;
   throwOnFail(d2dCtx.deviceCtx->CreateBitmapFromWicBitmap(
-    formatConverter.Get(),
+    decodeImage(factory, filename).Get(),
     nullptr,
     &bitmap
   ));
@@ -600,10 +615,67 @@ ComPtr<ID2D1Bitmap> loadBitmap(ComPtr<IWICImagingFactory> factory,
   return bitmap;
 }
 
+// ============================================================================
+// Load bitmap with WIC into the memory for the CPU renderer.
+// ============================================================================
+Bitmap loadCpuBitmap(ComPtr<IWICImagingFactory> factory,
+  const std::wstring& filename)
+{
+  auto source = decodeImage(factory, filename);
+
+  // query the size of the image to allocate the pixels.
+  UINT width = 0;
+  UINT height = 0;
+  throwOnFail(source->GetSize(&width, &height));
+
+  // copy the converted pixels into the bitmap row by row.
+  Bitmap bitmap(static_cast<int>(width), static_cast<int>(height));
+  throwOnFail(source->CopyPixels(
+    nullptr,
+    static_cast<UINT>(width * sizeof(uint32_t)),
+    static_cast<UINT>(bitmap.pixels.size() * sizeof(uint32_t)),
+    reinterpret_cast<BYTE*>(bitmap.pixels.data())
+  ));
+
+  // return the image that was loaded.
+  return bitmap;
+}
+
+// ============================================================================
+
+bool hasOption(int argc, char* argv[], const char* option)
+{
+  for (auto i = 1; i < argc; i++)
+    if (strcmp(argv[i], option) == 0)
+      return true;
+  return false;
+}
+
 // ============================================================================
 
-int main()
+int main(int argc, char* argv[])
 {
+  // run the validation and benchmark modes without opening the window.
+  if (hasOption(argc, argv, "--validate-raster"))
+    return validateRaster() ? 0 : 1;
+  if (hasOption(argc, argv, "--bench-raster")) {
+    benchRaster();
+    return 0;
+  }
+  if (hasOption(argc, argv, "--validate-blit"))
+    return validateBitmapKernels() ? 0 : 1;
+  if (hasOption(argc, argv, "--bench-blit")) {
+    benchBitmapKernels();
+    return 0;
+  }
+  if (hasOption(argc, argv, "--bench-tiles")) {
+    auto wicFactory = createWICFactory();
+    auto image = loadCpuBitmap(wicFactory, L"foo.png");
+    auto sheet = loadCpuBitmap(wicFactory, L"spritesheet.png");
+    benchTiles(image, sheet);
+    return 0;
+  }
+
   registerWindowClass();
   createWindow();
 
@@ -643,6 +715,34 @@ int main()
     &greenBrush
   ));
 
+  // draw the shapes and the bitmaps with the CPU renderer when requested. The
+  // shapes and the bitmaps are rendered as separate layers, which are uploaded
+  // into Direct2D bitmaps and drawn below and above the text and the SVG.
+  std::unique_ptr<TileRenderer> cpuRenderer;
+  Bitmap cpuShapes;
+  Bitmap cpuBitmaps;
+  Bitmap cpuImage;
+  Bitmap cpuSheet;
+  ComPtr<ID2D1Bitmap> shapesBitmap;
+  ComPtr<ID2D1Bitmap> bitmapsBitmap;
+  if (hasOption(argc, argv, "--cpu")) {
+    cpuRenderer = std::make_unique<TileRenderer>(WINDOW_WIDTH, WINDOW_HEIGHT);
+    cpuImage = loadCpuBitmap(wicFactory, L"foo.png");
+    cpuSheet = loadCpuBitmap(wicFactory, L"spritesheet.png");
+    for (auto layer : { &shapesBitmap, &bitmapsBitmap }) {
+      throwOnFail(d2dCtx.deviceCtx->CreateBitmap(
+        D2D1::SizeU(WINDOW_WIDTH, WINDOW_HEIGHT),
+        nullptr,
+        0,
+        D2D1::BitmapProperties(D2D1::PixelFormat(
+          DXGI_FORMAT_B8G8R8A8_UNORM,
+          D2D1_ALPHA_MODE_PREMULTIPLIED
+        )),
+        layer->GetAddressOf()
+      ));
+    }
+  }
+
   // start the main loop of the application.
   MSG msg = {};
   while (msg.message != WM_QUIT) {
@@ -666,13 +766,36 @@ int main()
 
     // query the size of the loaded bitmap image to be drawn.
     auto imageSize = image->GetSize();
+
+    // animate spritesheet images with a trivial animation.
+    static auto const TICKS_PER_FRAME = 50;
+    static auto frame = 0;
+    static auto frame_ticks = TICKS_PER_FRAME;
+    frame_ticks--;
+    if (frame_ticks <= 0) {
+      frame = (frame + 1) % 4;
+      frame_ticks = TICKS_PER_FRAME;
+    }
     
     // render to back buffer and then show it.
     d2dCtx.deviceCtx->BeginDraw();
-    d2dCtx.deviceCtx->Clear(D2D1::ColorF(D2D1::ColorF::Black));
-    d2dCtx.deviceCtx->SetTransform(rotation);
-    d2dCtx.deviceCtx->DrawRectangle({ 300, 200, 500, 400 }, whiteBrush.Get(), 10.f);
-    d2dCtx.deviceCtx->FillRectangle({ 300, 200, 500, 400 }, greenBrush.Get());
+    if (cpuRenderer) {
+      cpuRenderer->beginDraw();
+      drawSampleShapes(*cpuRenderer, angle);
+      cpuRenderer->endDraw(cpuShapes);
+      throwOnFail(shapesBitmap->CopyFromMemory(
+        nullptr,
+        cpuShapes.pixels.data(),
+        static_cast<UINT32>(cpuShapes.width * sizeof(uint32_t))
+      ));
+      d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Identity());
+      d2dCtx.deviceCtx->DrawBitmap(shapesBitmap.Get());
+    } else {
+      d2dCtx.deviceCtx->Clear(D2D1::ColorF(D2D1::ColorF::Black));
+      d2dCtx.deviceCtx->SetTransform(rotation);
+      d2dCtx.deviceCtx->DrawRectangle({ 300, 200, 500, 400 }, whiteBrush.Get(), 10.f);
+      d2dCtx.deviceCtx->FillRectangle({ 300, 200, 500, 400 }, greenBrush.Get());
+    }
     d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Identity());
     d2dCtx.deviceCtx->DrawTextA(
       L"Hello Direct2D!",
@@ -682,34 +805,37 @@ int main()
       whiteBrush.Get());
     d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Translation({150,100}));
     d2dCtx.deviceCtx->DrawSvgDocument(svg.Get());
-    d2dCtx.deviceCtx->DrawBitmap(
-      image.Get(),
-      D2D1::RectF(
-        0, 0, imageSize.width, imageSize.height
-      )
-    );
-
-    // animate spritesheet images with a trivial animation.
-    static auto const TICKS_PER_FRAME = 50;
-    static auto frame = 0;
-    static auto frame_ticks = TICKS_PER_FRAME;
-    frame_ticks--;
-    if (frame_ticks <= 0) {
-      frame = (frame + 1) % 4;
-      frame_ticks = TICKS_PER_FRAME;
+    if (cpuRenderer) {
+      cpuRenderer->beginDraw();
+      drawSampleBitmaps(*cpuRenderer, cpuImage, cpuSheet, frame);
+      cpuRenderer->endDraw(cpuBitmaps);
+      throwOnFail(bitmapsBitmap->CopyFromMemory(
+        nullptr,
+        cpuBitmaps.pixels.data(),
+        static_cast<UINT32>(cpuBitmaps.width * sizeof(uint32_t))
+      ));
+      d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Identity());
+      d2dCtx.deviceCtx->DrawBitmap(bitmapsBitmap.Get());
+    } else {
+      d2dCtx.deviceCtx->DrawBitmap(
+        image.Get(),
+        D2D1::RectF(
+          0, 0, imageSize.width, imageSize.height
+        )
+      );
+      d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Translation({ 500, 500 }));
+      d2dCtx.deviceCtx->DrawBitmap(
+        sheet.Get(),
+        D2D1::RectF(
+          0, 0, 25, 25
+        ),
+        1.f,
+        D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+        D2D1::RectF(
+          5 + (frame * 30), 5, 30 + (frame * 30), 30
+        )
+      );
     }
-    d2dCtx.deviceCtx->SetTransform(D2D1::Matrix3x2F::Translation({ 500, 500 }));
-    d2dCtx.deviceCtx->DrawBitmap(
-      sheet.Get(),
-      D2D1::RectF(
-        0, 0, 25, 25
-      ),
-      1.f,
-      D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
-      D2D1::RectF(
-        5 + (frame * 30), 5, 30 + (frame * 30), 30
-      )
-    );
 
     throwOnFail(d2dCtx.deviceCtx->EndDraw());
     throwOnFail(swapChain->Present(1, 0));
@@ -0,0 +1,860 @@
+#include "raster.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// ============================================================================
+
+constexpr auto PI = 3.14159265358979f;
+
+// the constant to approximate a quarter ellipse with a cubic Bezier curve.
+constexpr auto KAPPA = 0.5522847498f;
+
+// ============================================================================
+
+Matrix Matrix::identity()
+{
+  return {};
+}
+
+Matrix Matrix::translation(float x, float y)
+{
+  Matrix m;
+  m.dx = x;
+  m.dy = y;
+  return m;
+}
+
+Matrix Matrix::rotation(float degrees, Vec2 center)
+{
+  auto radians = degrees * PI / 180.f;
+  auto cos = std::cos(radians);
+  auto sin = std::sin(radians);
+
+  Matrix m;
+  m.m11 = cos;
+  m.m12 = sin;
+  m.m21 = -sin;
+  m.m22 = cos;
+  m.dx = center.x - center.x * cos + center.y * sin;
+  m.dy = center.y - center.x * sin - center.y * cos;
+  return m;
+}
+
+Matrix Matrix::scale(float x, float y, Vec2 center)
+{
+  Matrix m;
+  m.m11 = x;
+  m.m22 = y;
+  m.dx = center.x - x * center.x;
+  m.dy = center.y - y * center.y;
+  return m;
+}
+
+Vec2 Matrix::apply(Vec2 p) const
+{
+  return { p.x * m11 + p.y * m21 + dx, p.x * m12 + p.y * m22 + dy };
+}
+
+float Matrix::maxScale() const
+{
+  auto sx = m11 * m11 + m12 * m12;
+  auto sy = m21 * m21 + m22 * m22;
+  return std::sqrt(std::max(sx, sy));
+}
+
+bool Matrix::invert()
+{
+  auto det = m11 * m22 - m12 * m21;
+  if (det == 0.f || !std::isfinite(det))
+    return false;
+
+  auto inv = 1.f / det;
+  Matrix m;
+  m.m11 = m22 * inv;
+  m.m12 = -m12 * inv;
+  m.m21 = -m21 * inv;
+  m.m22 = m11 * inv;
+  m.dx = (m21 * dy - m22 * dx) * inv;
+  m.dy = (m12 * dx - m11 * dy) * inv;
+  *this = m;
+  return true;
+}
+
+Matrix operator*(const Matrix& lhs, const Matrix& rhs)
+{
+  Matrix m;
+  m.m11 = lhs.m11 * rhs.m11 + lhs.m12 * rhs.m21;
+  m.m12 = lhs.m11 * rhs.m12 + lhs.m12 * rhs.m22;
+  m.m21 = lhs.m21 * rhs.m11 + lhs.m22 * rhs.m21;
+  m.m22 = lhs.m21 * rhs.m12 + lhs.m22 * rhs.m22;
+  m.dx = lhs.dx * rhs.m11 + lhs.dy * rhs.m21 + rhs.dx;
+  m.dy = lhs.dx * rhs.m12 + lhs.dy * rhs.m22 + rhs.dy;
+  return m;
+}
+
+// ============================================================================
+
+namespace
+{
+
+inline Vec2 operator+(Vec2 a, Vec2 b) { return { a.x + b.x, a.y + b.y }; }
+inline Vec2 operator-(Vec2 a, Vec2 b) { return { a.x - b.x, a.y - b.y }; }
+inline Vec2 operator*(Vec2 a, float s) { return { a.x * s, a.y * s }; }
+
+inline float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+inline float cross(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+inline float length(Vec2 a) { return std::sqrt(dot(a, a)); }
+
+}
+
+// ============================================================================
+
+void Path::moveTo(Vec2 p)
+{
+  mVerbs.push_back(Verb::Move);
+  mPoints.push_back(p);
+}
+
+void Path::lineTo(Vec2 p)
+{
+  if (mVerbs.empty())
+    moveTo({ 0.f, 0.f });
+  mVerbs.push_back(Verb::Line);
+  mPoints.push_back(p);
+}
+
+void Path::quadTo(Vec2 c, Vec2 p)
+{
+  if (mVerbs.empty())
+    moveTo({ 0.f, 0.f });
+  mVerbs.push_back(Verb::Quad);
+  mPoints.push_back(c);
+  mPoints.push_back(p);
+}
+
+void Path::cubicTo(Vec2 c1, Vec2 c2, Vec2 p)
+{
+  if (mVerbs.empty())
+    moveTo({ 0.f, 0.f });
+  mVerbs.push_back(Verb::Cubic);
+  mPoints.push_back(c1);
+  mPoints.push_back(c2);
+  mPoints.push_back(p);
+}
+
+void Path::close()
+{
+  if (!mVerbs.empty() && mVerbs.back() != Verb::Close)
+    mVerbs.push_back(Verb::Close);
+}
+
+void Path::addRect(float left, float top, float right, float bottom)
+{
+  moveTo({ left, top });
+  lineTo({ right, top });
+  lineTo({ right, bottom });
+  lineTo({ left, bottom });
+  close();
+}
+
+void Path::addEllipse(Vec2 center, float rx, float ry)
+{
+  auto kx = rx * KAPPA;
+  auto ky = ry * KAPPA;
+  auto cx = center.x;
+  auto cy = center.y;
+  moveTo({ cx + rx, cy });
+  cubicTo({ cx + rx, cy + ky }, { cx + kx, cy + ry }, { cx, cy + ry });
+  cubicTo({ cx - kx, cy + ry }, { cx - rx, cy + ky }, { cx - rx, cy });
+  cubicTo({ cx - rx, cy - ky }, { cx - kx, cy - ry }, { cx, cy - ry });
+  cubicTo({ cx + kx, cy - ry }, { cx + rx, cy - ky }, { cx + rx, cy });
+  close();
+}
+
+void Path::clear()
+{
+  mVerbs.clear();
+  mPoints.clear();
+}
+
+// ============================================================================
+// Flatten the path into polylines.
+//
+// The amount of line segments for each curve is estimated with Wang's formula
+// which gives an upper bound for the segments needed to keep the distance
+// between the curve and its approximation under the given tolerance.
+//   n = ceil(sqrt(d * (d - 1) / 8 * M / tolerance))
+// where d is the degree of the curve and M the length of the largest second
+// difference of its control points.
+// ============================================================================
+std::vector<Path::Polyline> Path::flatten(float tolerance) const
+{
+  assert(tolerance > 0.f);
+
+  std::vector<Polyline> polylines;
+  Polyline current;
+  Vec2 start = { 0.f, 0.f };
+  Vec2 last = { 0.f, 0.f };
+
+  // finish the current figure and push it to the results.
+  auto flush = [&](bool closed) {
+    if (!current.points.empty()) {
+      current.closed = closed;
+      polylines.push_back(std::move(current));
+    }
+    current = {};
+  };
+
+  // start a new figure from the last point if the previous one was closed.
+  auto ensureStarted = [&]() {
+    if (current.points.empty())
+      current.points.push_back(last);
+  };
+
+  auto segments = [&](float degreeFactor, float m) {
+    auto n = std::ceil(std::sqrt(degreeFactor * m / tolerance));
+    return static_cast<int>(std::min(std::max(n, 1.f), 1024.f));
+  };
+
+  size_t p = 0;
+  for (auto verb : mVerbs) {
+    switch (verb) {
+    case Verb::Move:
+      flush(false);
+      start = last = mPoints[p++];
+      current.points.push_back(start);
+      break;
+    case Verb::Line:
+      ensureStarted();
+      last = mPoints[p++];
+      current.points.push_back(last);
+      break;
+    case Verb::Quad: {
+      ensureStarted();
+      auto p0 = last;
+      auto p1 = mPoints[p++];
+      auto p2 = mPoints[p++];
+      auto n = segments(0.25f, length(p0 - p1 * 2.f + p2));
+      for (auto i = 1; i < n; i++) {
+        auto t = static_cast<float>(i) / n;
+        auto u = 1.f - t;
+        current.points.push_back(p0 * (u * u) + p1 * (2.f * u * t) + p2 * (t * t));
+      }
+      current.points.push_back(p2);
+      last = p2;
+      break;
+    }
+    case Verb::Cubic: {
+      ensureStarted();
+      auto p0 = last;
+      auto p1 = mPoints[p++];
+      auto p2 = mPoints[p++];
+      auto p3 = mPoints[p++];
+      auto m = std::max(
+        length(p0 - p1 * 2.f + p2),
+        length(p1 - p2 * 2.f + p3));
+      auto n = segments(0.75f, m);
+      for (auto i = 1; i < n; i++) {
+        auto t = static_cast<float>(i) / n;
+        auto u = 1.f - t;
+        current.points.push_back(
+          p0 * (u * u * u) +
+          p1 * (3.f * u * u * t) +
+          p2 * (3.f * u * t * t) +
+          p3 * (t * t * t));
+      }
+      current.points.push_back(p3);
+      last = p3;
+      break;
+    }
+    case Verb::Close:
+      flush(true);
+      last = start;
+      break;
+    }
+  }
+  flush(false);
+  return polylines;
+}
+
+// ============================================================================
+
+uint8_t CoverageMask::at(int px, int py) const
+{
+  px -= x;
+  py -= y;
+  if (px < 0 || py < 0 || px >= width || py >= height)
+    return 0;
+  return coverage[py * width + px];
+}
+
+// ============================================================================
+// A collection of stroke outline contours.
+//
+// Each figure of a stroke is turned into a single contour that follows the left
+// side of the figure forwards, goes around the end cap, follows the right side
+// backwards and returns around the start cap. Closed figures have no caps, so
+// their left and right sides form two separate contours. The rasterizer sums
+// the coverage of the edges in each pixel, so the contours avoid overlapping
+// pieces to keep the coverage exact along the edges of the stroke. Only the
+// figures that cross or retrace themselves still produce overlapping edges.
+// ============================================================================
+namespace
+{
+
+struct Contours
+{
+  std::vector<Vec2> points;
+  std::vector<size_t> counts;
+
+  void add(Vec2 p) { points.push_back(p); }
+
+  // add the points between the ends of an arc that starts from the radius vector.
+  void addArc(Vec2 center, Vec2 from, float angle, float tolerance)
+  {
+    auto n = segments(std::abs(angle), length(from), tolerance);
+    for (auto i = 1; i < n; i++) {
+      auto cos = std::cos(angle * i / n);
+      auto sin = std::sin(angle * i / n);
+      points.push_back({
+        center.x + from.x * cos - from.y * sin,
+        center.y + from.x * sin + from.y * cos });
+    }
+  }
+
+  // finish the contour started after the previous one or drop it if empty.
+  void close()
+  {
+    auto count = points.size() - mFirst;
+    auto contour = points.data() + mFirst;
+    auto area = 0.f;
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+      area += cross(contour[j], contour[i]);
+
+    if (count < 3 || area == 0.f)
+      points.resize(mFirst);
+    else
+      counts.push_back(count);
+    mFirst = points.size();
+  }
+
+private:
+  // the amount of segments to keep an arc within the tolerance.
+  static int segments(float angle, float radius, float tolerance)
+  {
+    if (radius <= tolerance)
+      return 1;
+    auto step = 2.f * std::acos(1.f - tolerance / radius);
+    return std::min(std::max(static_cast<int>(std::ceil(angle / step)), 1), 1024);
+  }
+
+  size_t mFirst = 0;
+};
+
+}
+
+// ============================================================================
+// Add the points of a join on the left side of the figure.
+//
+// On the outer side of the turn the gap between the segments is filled based
+// on the line join. On the inner side the offset lines of the segments are cut
+// at their intersection. When the intersection does not fit within the
+// available lengths of the segments, the side is routed through the joint
+// instead, which keeps the contour closed around both segments.
+//
+// A figure that reverses onto itself has no inner side. The join is drawn
+// when the left side is followed forwards and routed through the joint when
+// the other side is followed backwards, so that it is drawn only once.
+// ============================================================================
+static void strokeJoin(Contours& out, const StrokeStyle& style, float tolerance,
+  Vec2 p, Vec2 d0, Vec2 d1, float available0, float available1, bool backwards)
+{
+  auto hw = style.width * .5f;
+  auto turn = cross(d0, d1);
+  Vec2 n0 = { -d0.y, d0.x };
+  Vec2 n1 = { -d1.y, d1.x };
+  auto a = p + n0 * hw;
+  auto b = p + n1 * hw;
+  if (turn == 0.f && dot(d0, d1) > 0.f) {
+    out.add(a);
+    return;
+  }
+
+  auto sum = n0 + n1;
+  auto len = length(sum);
+  auto reversal = turn == 0.f;
+  if (turn > 0.f || (reversal && backwards)) {
+    auto denominator = 1.f + dot(n0, n1);
+    if (denominator > 1e-6f) {
+      auto inner = p + sum * (hw / denominator);
+      if (-dot(inner - p, d0) <= available0 && dot(inner - p, d1) <= available1) {
+        out.add(inner);
+        return;
+      }
+    }
+    out.add(a);
+    out.add(p);
+    out.add(b);
+    return;
+  }
+
+  // round joins follow an arc rotating from the first normal around the joint.
+  out.add(a);
+  if (style.lineJoin == LineJoin::Round) {
+    auto angle = std::atan2(std::abs(cross(n0, n1)), dot(n0, n1));
+    out.addArc(p, n0 * hw, -angle, tolerance);
+  } else if (style.lineJoin != LineJoin::Bevel) {
+    // the ratio between the miter length and half of the width is 1/cos(a/2).
+    if (len > 0.f && 2.f / len <= style.miterLimit) {
+      out.add(p + sum * (hw * 2.f / (len * len)));
+    } else if (style.lineJoin == LineJoin::Miter) {
+      // clip the miter with a line perpendicular to the outer bisector at the
+      // miter limit distance. A reversal has no bisector, so it extends forward.
+      auto limit = std::max(style.miterLimit, 1.f) * hw;
+      auto outward = len > 1e-6f ? sum * (1.f / len) : d0;
+      auto along0 = dot(d0, outward);
+      auto along1 = -dot(d1, outward);
+      if (along0 > 1e-6f && along1 > 1e-6f) {
+        out.add(a + d0 * ((limit - dot(a - p, outward)) / along0));
+        out.add(b - d1 * ((limit - dot(b - p, outward)) / along1));
+      }
+    }
+  }
+  out.add(b);
+}
+
+// ============================================================================
+// Add the points of a cap going from the left side to the right side around
+// the end point p, where d is the direction the figure leaves the point.
+// ============================================================================
+static void strokeCap(Contours& out, CapStyle cap, float hw, float tolerance,
+  Vec2 p, Vec2 d)
+{
+  Vec2 n = { -d.y * hw, d.x * hw };
+  out.add(p + n);
+  switch (cap) {
+  case CapStyle::Flat:
+    break;
+  case CapStyle::Square:
+    out.add(p + n + d * hw);
+    out.add(p - n + d * hw);
+    break;
+  case CapStyle::Round:
+    out.addArc(p, n, -PI, tolerance);
+    break;
+  }
+  out.add(p - n);
+}
+
+// ============================================================================
+// Add the joins on the left side of the points. The sides of a closed figure
+// are joined at every point, while an open figure leaves its ends to the caps.
+// ============================================================================
+static void strokeSide(Contours& out, const StrokeStyle& style, float tolerance,
+  const std::vector<Vec2>& pts, bool closed, bool backwards)
+{
+  auto count = pts.size();
+  auto segments = closed ? count : count - 1;
+  std::vector<Vec2> dirs(segments);
+  std::vector<float> lengths(segments);
+  for (size_t i = 0; i < segments; i++) {
+    auto d = pts[(i + 1) % count] - pts[i];
+    lengths[i] = length(d);
+    dirs[i] = d * (1.f / lengths[i]);
+  }
+
+  // the segments between two joins have half of their length for each join.
+  auto available = [&](size_t segment) {
+    auto end = !closed && (segment == 0 || segment == segments - 1);
+    return end && segments > 1 ? lengths[segment] : lengths[segment] * .5f;
+  };
+  for (size_t i = closed ? 0 : 1; i < segments; i++) {
+    auto previous = (i + segments - 1) % segments;
+    strokeJoin(out, style, tolerance, pts[i], dirs[previous], dirs[i],
+      available(previous), available(i), backwards);
+  }
+}
+
+// ============================================================================
+
+static void strokePolyline(Contours& out, const StrokeStyle& style,
+  float tolerance, const Path::Polyline& polyline)
+{
+  auto hw = style.width * .5f;
+
+  // drop the repeated points as they have no direction.
+  std::vector<Vec2> pts;
+  pts.reserve(polyline.points.size());
+  for (auto& p : polyline.points)
+    if (pts.empty() || p.x != pts.back().x || p.y != pts.back().y)
+      pts.push_back(p);
+  auto closed = polyline.closed;
+  if (closed && pts.size() > 1 &&
+      pts.front().x == pts.back().x && pts.front().y == pts.back().y)
+    pts.pop_back();
+
+  // a figure without any length is drawn as a dot when it has caps.
+  if (pts.size() == 1) {
+    strokeCap(out, style.endCap, hw, tolerance, pts[0], { 1.f, 0.f });
+    strokeCap(out, style.startCap, hw, tolerance, pts[0], { -1.f, 0.f });
+    out.close();
+    return;
+  }
+
+  // the left side of a closed figure of two points already goes around it.
+  std::vector<Vec2> reversed(pts.rbegin(), pts.rend());
+  if (closed) {
+    strokeSide(out, style, tolerance, pts, true, false);
+    out.close();
+    if (pts.size() > 2) {
+      strokeSide(out, style, tolerance, reversed, true, true);
+      out.close();
+    }
+    return;
+  }
+
+  auto last = pts.size() - 1;
+  auto d0 = pts[1] - pts[0];
+  auto d1 = pts[last] - pts[last - 1];
+  strokeSide(out, style, tolerance, pts, false, false);
+  strokeCap(out, style.endCap, hw, tolerance, pts[last], d1 * (1.f / length(d1)));
+  strokeSide(out, style, tolerance, reversed, false, true);
+  strokeCap(out, style.startCap, hw, tolerance, pts[0], d0 * (-1.f / length(d0)));
+  out.close();
+}
+
+// ============================================================================
+
+void Outline::addFill(const Path& path, const Matrix& transform)
+{
+  auto scale = std::max(transform.maxScale(), 1e-6f);
+  for (auto& polyline : path.flatten(Rasterizer::TOLERANCE / scale)) {
+    if (polyline.points.size() < 2)
+      continue;
+    for (auto& p : polyline.points)
+      points.push_back(transform.apply(p));
+    counts.push_back(polyline.points.size());
+  }
+}
+
+void Outline::addStroke(const Path& path, const StrokeStyle& style,
+  const Matrix& transform)
+{
+  if (style.width <= 0.f)
+    return;
+
+  // the outline is built in user space so that the width follows transform.
+  auto scale = std::max(transform.maxScale(), 1e-6f);
+  auto tolerance = Rasterizer::TOLERANCE / scale;
+  Contours contours;
+  for (auto& polyline : path.flatten(tolerance))
+    strokePolyline(contours, style, tolerance, polyline);
+
+  for (auto& p : contours.points)
+    points.push_back(transform.apply(p));
+  counts.insert(counts.end(), contours.counts.begin(), contours.counts.end());
+}
+
+RectF Outline::bounds() const
+{
+  if (points.empty())
+    return { 0.f, 0.f, 0.f, 0.f };
+
+  RectF rect = { points[0].x, points[0].y, points[0].x, points[0].y };
+  for (auto& p : points) {
+    rect.left = std::min(rect.left, p.x);
+    rect.top = std::min(rect.top, p.y);
+    rect.right = std::max(rect.right, p.x);
+    rect.bottom = std::max(rect.bottom, p.y);
+  }
+  return rect;
+}
+
+void Outline::clear()
+{
+  points.clear();
+  counts.clear();
+}
+
+// ============================================================================
+
+Rasterizer::Rasterizer(int width, int height)
+{
+  setClip(width, height);
+}
+
+void Rasterizer::setClip(int width, int height)
+{
+  reset();
+  mWidth = std::max(width, 0);
+  mHeight = std::max(height, 0);
+  mRows.resize(mHeight);
+}
+
+void Rasterizer::reset()
+{
+  for (auto y = mMinY; y <= mMaxY; y++)
+    mRows[y].clear();
+  mMinY = mHeight;
+  mMaxY = -1;
+  mMinX = mWidth;
+  mMaxX = -1;
+}
+
+// ============================================================================
+
+void Rasterizer::addPath(const Path& path, const Matrix& transform)
+{
+  mOutline.clear();
+  mOutline.addFill(path, transform);
+  addOutline(mOutline);
+}
+
+void Rasterizer::addStroke(const Path& path, const StrokeStyle& style,
+  const Matrix& transform)
+{
+  mOutline.clear();
+  mOutline.addStroke(path, style, transform);
+  addOutline(mOutline);
+}
+
+void Rasterizer::addOutline(const Outline& outline, Vec2 offset)
+{
+  auto points = outline.points.data();
+  for (auto count : outline.counts) {
+    auto first = points[0] + offset;
+    auto prev = first;
+    for (size_t i = 1; i < count; i++) {
+      auto next = points[i] + offset;
+      addLine(prev, next);
+      prev = next;
+    }
+    addLine(prev, first);
+    points += count;
+  }
+}
+
+// ============================================================================
+// Add a directed edge to the cell buffer.
+//
+// The edge is clipped vertically against the clip area and split at the left
+// and the right clip edges. Parts left of the clip area still affect the
+// coverage of every pixel on their right, so they are collapsed to a vertical
+// line just outside the clip area. Parts right of the clip area never affect
+// visible pixels and are dropped.
+// ============================================================================
+void Rasterizer::addLine(Vec2 p0, Vec2 p1)
+{
+  if (p0.y == p1.y || !std::isfinite(p0.x + p0.y + p1.x + p1.y))
+    return;
+
+  // work from top to bottom while remembering the original direction.
+  auto dir = 1.f;
+  if (p0.y > p1.y) {
+    std::swap(p0, p1);
+    dir = -1.f;
+  }
+
+  // clip the edge against the top and the bottom of the clip area.
+  auto height = static_cast<float>(mHeight);
+  if (p1.y <= 0.f || p0.y >= height)
+    return;
+  auto dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+  if (p0.y < 0.f) {
+    p0.x += dxdy * (0.f - p0.y);
+    p0.y = 0.f;
+  }
+  if (p1.y > height) {
+    p1.x += dxdy * (height - p1.y);
+    p1.y = height;
+  }
+
+  // split the edge at the left and the right edges of the clip area.
+  auto width = static_cast<float>(mWidth);
+  Vec2 pts[4] = { p0 };
+  auto n = 1;
+  for (auto bound : { 0.f, width }) {
+    if ((p0.x < bound) != (p1.x < bound) && p0.x != bound && p1.x != bound) {
+      auto y = p0.y + (bound - p0.x) * (p1.y - p0.y) / (p1.x - p0.x);
+      pts[n++] = { bound, y };
+    }
+  }
+  if (n == 3 && (pts[2].y < pts[1].y))
+    std::swap(pts[1], pts[2]);
+  pts[n++] = p1;
+
+  for (auto i = 0; i + 1 < n; i++) {
+    auto a = pts[i];
+    auto b = pts[i + 1];
+    auto midX = (a.x + b.x) * .5f;
+    if (a.y >= b.y)
+      continue;
+    if (midX >= width) {
+      mMaxX = mWidth - 1;
+      continue;
+    }
+    if (midX <= 0.f)
+      a.x = b.x = -1.f;
+
+    // deposit the edge into each of the scanlines it crosses.
+    auto segmentDxDy = (b.x - a.x) / (b.y - a.y);
+    auto row = static_cast<int>(a.y);
+    auto y0 = a.y;
+    auto x0 = a.x;
+    while (y0 < b.y) {
+      auto y1 = std::min(static_cast<float>(row + 1), b.y);
+      auto x1 = (y1 == b.y) ? b.x : a.x + segmentDxDy * (y1 - a.y);
+      if (dir > 0.f)
+        addRowSegment(row, x0, y0 - row, x1, y1 - row);
+      else
+        addRowSegment(row, x1, y1 - row, x0, y0 - row);
+      x0 = x1;
+      y0 = y1;
+      row++;
+    }
+  }
+}
+
+// ============================================================================
+// Deposit a segment that lies within a single scanline into the cells.
+//
+// Each cell receives the signed height of the segment part inside it (cover)
+// and that height multiplied by the average distance of the part from the left
+// edge of the cell (area). The coverage of a pixel is then the sum of the cover
+// of all cells on its left plus its own cover minus its own area.
+// ============================================================================
+void Rasterizer::addRowSegment(int row, float x0, float y0, float x1, float y1)
+{
+  auto cx0 = static_cast<int>(std::floor(x0));
+  auto cx1 = static_cast<int>(std::floor(x1));
+  if (cx0 == cx1) {
+    auto dy = y1 - y0;
+    addCell(row, cx0, dy, dy * ((x0 + x1) * .5f - cx0));
+    return;
+  }
+
+  // walk through the cells between the end points one at a time.
+  auto dydx = (y1 - y0) / (x1 - x0);
+  auto step = cx1 > cx0 ? 1 : -1;
+  auto x = x0;
+  auto y = y0;
+  for (auto cx = cx0; ; cx += step) {
+    auto last = cx == cx1;
+    auto nx = last ? x1 : static_cast<float>(step > 0 ? cx + 1 : cx);
+    auto ny = last ? y1 : y0 + (nx - x0) * dydx;
+    auto dy = ny - y;
+    if (dy != 0.f)
+      addCell(row, cx, dy, dy * ((x + nx) * .5f - cx));
+    if (last)
+      break;
+    x = nx;
+    y = ny;
+  }
+}
+
+// ============================================================================
+
+void Rasterizer::addCell(int row, int x, float cover, float area)
+{
+  mMinY = std::min(mMinY, row);
+  mMaxY = std::max(mMaxY, row);
+
+  // cells outside the left edge only matter for the cells on their right and
+  // cells outside the right edge leave the rest of the scanline covered.
+  if (x < 0) {
+    x = -1;
+  } else if (x >= mWidth) {
+    mMaxX = mWidth - 1;
+    return;
+  }
+
+  auto& cells = mRows[row];
+  if (!cells.empty() && cells.back().x == x) {
+    cells.back().cover += cover;
+    cells.back().area += area;
+  } else {
+    cells.push_back({ x, cover, area });
+  }
+
+  mMinX = std::min(mMinX, std::max(x, 0));
+  mMaxX = std::max(mMaxX, x);
+}
+
+// ============================================================================
+
+CoverageMask Rasterizer::rasterize(FillRule rule)
+{
+  CoverageMask mask;
+  rasterize(rule, mask);
+  return mask;
+}
+
+// ============================================================================
+// Resolve the cell buffer into a coverage mask.
+//
+// The cells of each scanline are sorted and swept from left to right while
+// accumulating the cover. The pixels between two cells are covered by the
+// accumulated winding, which is then mapped to a coverage with the fill rule.
+// ============================================================================
+void Rasterizer::rasterize(FillRule rule, CoverageMask& mask)
+{
+  mask.x = mMinX;
+  mask.y = mMinY;
+  mask.width = std::max(mMaxX - mMinX + 1, 0);
+  mask.height = std::max(mMaxY - mMinY + 1, 0);
+  mask.coverage.assign(static_cast<size_t>(mask.width) * mask.height, 0);
+  if (mask.empty()) {
+    reset();
+    return;
+  }
+
+  auto toCoverage = [rule](float winding) -> uint8_t {
+    auto value = std::abs(winding);
+    if (rule == FillRule::NonZero) {
+      value = std::min(value, 1.f);
+    } else {
+      value -= 2.f * std::floor(value * .5f);
+      if (value > 1.f)
+        value = 2.f - value;
+    }
+    return static_cast<uint8_t>(value * 255.f + .5f);
+  };
+
+  for (auto y = mMinY; y <= mMaxY; y++) {
+    auto& cells = mRows[y];
+    if (cells.empty())
+      continue;
+    std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+      return a.x < b.x;
+    });
+
+    auto line = mask.coverage.data() + static_cast<size_t>(y - mMinY) * mask.width;
+    auto accumulation = 0.f;
+    for (size_t i = 0; i < cells.size();) {
+      // merge all the cells at the same position.
+      auto x = cells[i].x;
+      auto cover = 0.f;
+      auto area = 0.f;
+      for (; i < cells.size() && cells[i].x == x; i++) {
+        cover += cells[i].cover;
+        area += cells[i].area;
+      }
+
+      if (x >= 0)
+        line[x - mMinX] = toCoverage(accumulation + cover - area);
+      accumulation += cover;
+
+      // fill the span between this and the next cell.
+      auto end = i < cells.size() ? cells[i].x : mMaxX + 1;
+      auto begin = std::max(x + 1, mMinX);
+      if (begin < end) {
+        auto value = toCoverage(accumulation);
+        if (value != 0)
+          std::fill(line + (begin - mMinX), line + (end - mMinX), value);
+      }
+    }
+  }
+  reset();
+}
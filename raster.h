@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// A portable anti-aliased scanline path rasterizer.
+//
+// Rasterizer converts vector paths into 8-bit coverage masks without relying
+// on Direct2D, so the same geometry can be rendered on the CPU and compared
+// against what the GPU produces. Coverage is computed analytically: each edge
+// deposits the exact signed area it covers into the pixel cells it crosses,
+// and a single sweep over each scanline turns those deposits into coverage.
+//
+// Only the cells that edges actually touch are stored (a sparse cell buffer),
+// while the spans between them are filled from the running accumulation. This
+// keeps the memory and time proportional to the length of the outline rather
+// than the area of the shape. The coverage is exact for pixels where edges do
+// not cross each other, while pixels containing crossings are approximated.
+//
+// The rasterizer supports the same fill rules as Direct2D geometries.
+//   FillRule::NonZero...Fill areas where the winding number is not zero.
+//   FillRule::EvenOdd...Fill areas where the winding number is odd.
+//
+// Strokes are converted into outline polygons before rasterization. Here's a
+// list of the supported line joins and caps (same semantics as Direct2D).
+//   LineJoin::Miter..........Sharp corners, clipped at the miter limit.
+//   LineJoin::Bevel..........Corners are cut off.
+//   LineJoin::Round..........Corners are rounded with an arc.
+//   LineJoin::MiterOrBevel...Sharp corners, bevel past the miter limit.
+//   CapStyle::Flat....Lines end exactly at the end points.
+//   CapStyle::Square..Lines are extended by half of the stroke width.
+//   CapStyle::Round...Lines are ended with a half circle.
+// ============================================================================
+
+struct Vec2
+{
+  float x;
+  float y;
+};
+
+struct RectF
+{
+  float left;
+  float top;
+  float right;
+  float bottom;
+};
+
+// ============================================================================
+// An affine 2D transformation with the same layout as D2D1_MATRIX_3X2_F.
+//   x' = x * m11 + y * m21 + dx
+//   y' = x * m12 + y * m22 + dy
+// ============================================================================
+struct Matrix
+{
+  float m11 = 1.f, m12 = 0.f;
+  float m21 = 0.f, m22 = 1.f;
+  float dx = 0.f, dy = 0.f;
+
+  static Matrix identity();
+  static Matrix translation(float x, float y);
+  static Matrix rotation(float degrees, Vec2 center);
+  static Matrix scale(float x, float y, Vec2 center);
+
+  Vec2 apply(Vec2 p) const;
+  float maxScale() const;
+
+  // invert the transform in place. Returns false if it is not invertible.
+  bool invert();
+};
+
+// combine two transforms so that the lhs is applied before the rhs.
+Matrix operator*(const Matrix& lhs, const Matrix& rhs);
+
+// ============================================================================
+
+enum class FillRule { NonZero, EvenOdd };
+enum class LineJoin { Miter, Bevel, Round, MiterOrBevel };
+enum class CapStyle { Flat, Square, Round };
+
+struct StrokeStyle
+{
+  float width = 1.f;
+  LineJoin lineJoin = LineJoin::Miter;
+  CapStyle startCap = CapStyle::Flat;
+  CapStyle endCap = CapStyle::Flat;
+  float miterLimit = 10.f;
+};
+
+// ============================================================================
+// A vector path built from one or more figures.
+//
+// Each figure starts with a moveTo and is followed by lines and Bezier curves.
+// Closing a figure joins the last point back to the first one, which matters
+// for strokes because closed figures are joined instead of capped.
+// ============================================================================
+class Path
+{
+public:
+  void moveTo(Vec2 p);
+  void lineTo(Vec2 p);
+  void quadTo(Vec2 c, Vec2 p);
+  void cubicTo(Vec2 c1, Vec2 c2, Vec2 p);
+  void close();
+
+  void addRect(float left, float top, float right, float bottom);
+  void addEllipse(Vec2 center, float rx, float ry);
+
+  void clear();
+  bool empty() const { return mVerbs.empty(); }
+
+  // a figure flattened into a polyline.
+  struct Polyline
+  {
+    std::vector<Vec2> points;
+    bool closed = false;
+  };
+
+  // flatten curves into line segments with the given maximum deviation.
+  std::vector<Polyline> flatten(float tolerance) const;
+
+private:
+  enum class Verb : uint8_t { Move, Line, Quad, Cubic, Close };
+
+  std::vector<Verb> mVerbs;
+  std::vector<Vec2> mPoints;
+};
+
+// ============================================================================
+// A set of closed polygons in device space.
+//
+// Outline holds the flattened and transformed form of filled and stroked paths
+// so that the same geometry can be rasterized several times (e.g. once for each
+// screen tile it touches) without flattening or stroking it again.
+// ============================================================================
+struct Outline
+{
+  std::vector<Vec2> points;
+  std::vector<size_t> counts;
+
+  void addFill(const Path& path, const Matrix& transform);
+  void addStroke(const Path& path, const StrokeStyle& style,
+    const Matrix& transform);
+
+  // the bounding box of all the points, or an empty rectangle.
+  RectF bounds() const;
+
+  void clear();
+  bool empty() const { return counts.empty(); }
+};
+
+// ============================================================================
+// An 8-bit coverage mask covering the rectangle [x, x+width) x [y, y+height).
+// ============================================================================
+struct CoverageMask
+{
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> coverage;
+
+  bool empty() const { return width <= 0 || height <= 0; }
+  uint8_t at(int px, int py) const;
+};
+
+// ============================================================================
+
+class Rasterizer
+{
+public:
+  // the maximum distance between a curve and its flattened line segments.
+  static constexpr float TOLERANCE = 0.25f;
+
+  explicit Rasterizer(int width = 0, int height = 0);
+
+  // restrict the produced coverage to the [0, width) x [0, height) area.
+  void setClip(int width, int height);
+
+  // add the outline of a filled path after transforming it.
+  void addPath(const Path& path, const Matrix& transform);
+
+  // add the outline of a stroked path. Strokes must be resolved with NonZero.
+  void addStroke(const Path& path, const StrokeStyle& style,
+    const Matrix& transform);
+
+  // add the polygons of an outline after moving them by the given offset.
+  void addOutline(const Outline& outline, Vec2 offset = { 0.f, 0.f });
+
+  // add a single directed edge in device space.
+  void addLine(Vec2 p0, Vec2 p1);
+
+  // resolve the accumulated edges into a mask and reset the rasterizer.
+  CoverageMask rasterize(FillRule rule);
+  void rasterize(FillRule rule, CoverageMask& mask);
+
+  void reset();
+
+private:
+  struct Cell
+  {
+    int x;
+    float cover;
+    float area;
+  };
+
+  void addRowSegment(int row, float x0, float y0, float x1, float y1);
+  void addCell(int row, int x, float cover, float area);
+
+  int mWidth = 0;
+  int mHeight = 0;
+  int mMinY = 0;
+  int mMaxY = -1;
+  int mMinX = 0;
+  int mMaxX = -1;
+  std::vector<std::vector<Cell>> mRows;
+  Outline mOutline;
+};
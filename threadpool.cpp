@@ -0,0 +1,125 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+// ============================================================================
+
+ThreadPool::ThreadPool(unsigned workers) : mTask(nullptr), mRemaining(0)
+{
+  if (workers == 0)
+    workers = std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (auto i = 0u; i < workers; i++)
+    mQueues.push_back(std::make_unique<Queue>());
+
+  // the worker zero is the thread that calls the parallelFor.
+  for (auto i = 1u; i < workers; i++)
+    mThreads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mWake.notify_all();
+  for (auto& thread : mThreads)
+    thread.join();
+}
+
+// ============================================================================
+
+void ThreadPool::parallelFor(size_t count, const Task& task)
+{
+  if (count == 0)
+    return;
+
+  // avoid the synchronization when there is nothing to share.
+  if (size() == 1 || count == 1) {
+    for (size_t i = 0; i < count; i++)
+      task(i, 0);
+    return;
+  }
+
+  // the task must be published before the items that refer to it.
+  mTask.store(&task);
+  mRemaining.store(count);
+
+  // split the indices into contiguous chunks, one for each worker.
+  size_t workers = size();
+  for (size_t q = 0; q < workers; q++) {
+    auto begin = count * q / workers;
+    auto end = count * (q + 1) / workers;
+    std::lock_guard<std::mutex> lock(mQueues[q]->mutex);
+    for (auto i = begin; i < end; i++)
+      mQueues[q]->items.push_back(i);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mGeneration++;
+  }
+  mWake.notify_all();
+
+  // help with the work and then wait for the items still being processed.
+  while (runOne(0)) {}
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDone.wait(lock, [this]() { return mRemaining.load() == 0; });
+}
+
+// ============================================================================
+
+void ThreadPool::workerLoop(unsigned worker)
+{
+  unsigned long long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mWake.wait(lock, [&]() { return mStop || mGeneration != seen; });
+      if (mStop)
+        return;
+      seen = mGeneration;
+    }
+    while (runOne(worker)) {}
+  }
+}
+
+// ============================================================================
+// Execute a single work item.
+//
+// The worker first takes an item from the front of its own queue. If the queue
+// is empty, it tries to steal an item from the back of the other queues, which
+// keeps the stolen work away from the items the victim is going to run next.
+// ============================================================================
+bool ThreadPool::runOne(unsigned worker)
+{
+  size_t item = 0;
+  auto found = false;
+  auto workers = size();
+  for (auto i = 0u; i < workers && !found; i++) {
+    auto& queue = *mQueues[(worker + i) % workers];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty())
+      continue;
+    if (i == 0) {
+      item = queue.items.front();
+      queue.items.pop_front();
+    } else {
+      item = queue.items.back();
+      queue.items.pop_back();
+    }
+    found = true;
+  }
+  if (!found)
+    return false;
+
+  (*mTask.load())(item, worker);
+
+  // wake up the caller after the last item has been finished.
+  if (mRemaining.fetch_sub(1) == 1) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDone.notify_all();
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// A work-stealing thread pool for data parallel loops.
+//
+// Each worker owns a queue of work items. A parallel loop splits its indices
+// into contiguous chunks, one for each queue, so that neighbouring items (e.g.
+// neighbouring screen tiles) tend to be processed by the same worker. Workers
+// take items from the front of their own queue and, when it runs empty, steal
+// items from the back of the other queues to balance uneven workloads.
+//
+// The calling thread takes part in the work as the worker zero, so a pool with
+// a single worker runs everything on the calling thread without any threads.
+// ============================================================================
+class ThreadPool
+{
+public:
+  // the task receives the item index and the index of the executing worker.
+  using Task = std::function<void(size_t index, unsigned worker)>;
+
+  // create a pool with the given amount of workers (0 = all hardware threads).
+  explicit ThreadPool(unsigned workers = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned size() const { return static_cast<unsigned>(mQueues.size()); }
+
+  // run the task for each index in [0, count) and wait for all to finish.
+  void parallelFor(size_t count, const Task& task);
+
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<size_t> items;
+  };
+
+  void workerLoop(unsigned worker);
+  bool runOne(unsigned worker);
+
+  std::vector<std::unique_ptr<Queue>> mQueues;
+  std::vector<std::thread> mThreads;
+
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::condition_variable mDone;
+  std::atomic<const Task*> mTask;
+  std::atomic<size_t> mRemaining;
+  unsigned long long mGeneration = 0;
+  bool mStop = false;
+};
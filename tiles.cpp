@@ -0,0 +1,210 @@
+#include "tiles.h"
+
+#include <algorithm>
+#include <cassert>
+
+// ============================================================================
+
+TileRenderer::TileRenderer(int width, int height, unsigned threads)
+  : mWidth(width),
+    mHeight(height),
+    mColumns((width + TILE_SIZE - 1) / TILE_SIZE),
+    mRows((height + TILE_SIZE - 1) / TILE_SIZE),
+    mBins(static_cast<size_t>(mColumns) * mRows)
+{
+  assert(width > 0 && height > 0);
+  setThreadCount(threads);
+}
+
+void TileRenderer::setThreadCount(unsigned threads)
+{
+  mPool = std::make_unique<ThreadPool>(threads);
+  mScratch.clear();
+  mScratch.resize(mPool->size());
+}
+
+// ============================================================================
+
+void TileRenderer::beginDraw()
+{
+  mTransform = Matrix::identity();
+  mCommands.clear();
+  mOutlineCount = 0;
+  for (auto& bin : mBins)
+    bin.clear();
+}
+
+// ============================================================================
+// Bin the recorded commands into tiles and render the tiles in parallel.
+//
+// Binning is done on the calling thread in the recording order, which makes
+// each bin list the commands touching its tile in the painter's order. After
+// that each tile can be rendered independently of all the other tiles.
+// ============================================================================
+void TileRenderer::endDraw(Bitmap& target)
+{
+  if (target.width != mWidth || target.height != mHeight)
+    target = Bitmap(mWidth, mHeight);
+
+  IntRect screen = { 0, 0, mWidth, mHeight };
+  for (size_t i = 0; i < mCommands.size(); i++) {
+    auto bounds = intersect(mCommands[i].bounds, screen);
+    if (bounds.empty())
+      continue;
+    auto right = (bounds.right - 1) / TILE_SIZE;
+    auto bottom = (bounds.bottom - 1) / TILE_SIZE;
+    for (auto ty = bounds.top / TILE_SIZE; ty <= bottom; ty++)
+      for (auto tx = bounds.left / TILE_SIZE; tx <= right; tx++)
+        mBins[ty * mColumns + tx].push_back(static_cast<uint32_t>(i));
+  }
+
+  mPool->parallelFor(mBins.size(), [&](size_t tile, unsigned worker) {
+    renderTile(tile, worker, target);
+  });
+}
+
+// ============================================================================
+
+void TileRenderer::renderTile(size_t tile, unsigned worker, Bitmap& target)
+{
+  auto& bin = mBins[tile];
+  if (bin.empty())
+    return;
+
+  auto x = static_cast<int>(tile % mColumns) * TILE_SIZE;
+  auto y = static_cast<int>(tile / mColumns) * TILE_SIZE;
+  IntRect rect = {
+    x,
+    y,
+    std::min(x + TILE_SIZE, mWidth),
+    std::min(y + TILE_SIZE, mHeight)
+  };
+
+  auto& scratch = mScratch[worker];
+  for (auto index : bin) {
+    auto& command = mCommands[index];
+    auto clip = intersect(rect, command.bounds);
+    switch (command.type) {
+    case CommandType::Clear:
+      fillRect(target, clip, command.pixel);
+      break;
+    case CommandType::Fill:
+      scratch.rasterizer.addOutline(mOutlines[command.outline],
+        { static_cast<float>(-x), static_cast<float>(-y) });
+      scratch.rasterizer.rasterize(command.rule, scratch.mask);
+      blendMask(target, clip, scratch.mask, x, y, command.pixel);
+      break;
+    case CommandType::Bitmap:
+      ::drawBitmap(target, clip, *command.bitmap, command.source,
+        command.inverse, command.opacity, command.interpolation);
+      break;
+    }
+  }
+}
+
+// ============================================================================
+
+Outline& TileRenderer::nextOutline()
+{
+  // outlines are reused between frames to keep their allocated memory.
+  if (mOutlineCount == mOutlines.size())
+    mOutlines.emplace_back();
+  auto& outline = mOutlines[mOutlineCount];
+  outline.clear();
+  return outline;
+}
+
+void TileRenderer::addOutlineCommand(const Color& color, FillRule rule)
+{
+  auto& outline = mOutlines[mOutlineCount];
+  if (outline.empty())
+    return;
+
+  Command command = {};
+  command.type = CommandType::Fill;
+  command.bounds = enclosingRect(outline.bounds());
+  command.pixel = premultiply(color);
+  command.rule = rule;
+  command.outline = mOutlineCount++;
+  mCommands.push_back(command);
+}
+
+// ============================================================================
+
+void TileRenderer::clear(const Color& color)
+{
+  Command command = {};
+  command.type = CommandType::Clear;
+  command.bounds = { 0, 0, mWidth, mHeight };
+  command.pixel = premultiply(color);
+  mCommands.push_back(command);
+}
+
+void TileRenderer::fillRectangle(const RectF& rect, const Color& color)
+{
+  mPath.clear();
+  mPath.addRect(rect.left, rect.top, rect.right, rect.bottom);
+  fillPath(mPath, color);
+}
+
+void TileRenderer::drawRectangle(const RectF& rect, const Color& color,
+  float strokeWidth)
+{
+  StrokeStyle style;
+  style.width = strokeWidth;
+  mPath.clear();
+  mPath.addRect(rect.left, rect.top, rect.right, rect.bottom);
+  drawPath(mPath, color, style);
+}
+
+void TileRenderer::fillPath(const Path& path, const Color& color,
+  FillRule rule)
+{
+  nextOutline().addFill(path, mTransform);
+  addOutlineCommand(color, rule);
+}
+
+void TileRenderer::drawPath(const Path& path, const Color& color,
+  const StrokeStyle& style)
+{
+  nextOutline().addStroke(path, style, mTransform);
+  addOutlineCommand(color, FillRule::NonZero);
+}
+
+// ============================================================================
+// Record a bitmap draw command.
+//
+// The source rectangle is mapped onto the destination rectangle, which is then
+// transformed with the current transform. The command stores the inverse of
+// the combined transform to map the target pixels back into the bitmap.
+// ============================================================================
+void TileRenderer::drawBitmap(const Bitmap& bitmap, const RectF& destination,
+  float opacity, Interpolation interpolation, const RectF* source)
+{
+  auto src = source ? *source : RectF{
+    0.f, 0.f, static_cast<float>(bitmap.width), static_cast<float>(bitmap.height)
+  };
+  auto srcWidth = src.right - src.left;
+  auto srcHeight = src.bottom - src.top;
+  if (srcWidth <= 0.f || srcHeight <= 0.f)
+    return;
+
+  Matrix mapping;
+  mapping.m11 = (destination.right - destination.left) / srcWidth;
+  mapping.m22 = (destination.bottom - destination.top) / srcHeight;
+  mapping.dx = destination.left - src.left * mapping.m11;
+  mapping.dy = destination.top - src.top * mapping.m22;
+  auto transform = mapping * mTransform;
+
+  Command command = {};
+  command.type = CommandType::Bitmap;
+  command.inverse = transform;
+  if (!command.inverse.invert())
+    return;
+  command.bounds = enclosingRect(transformBounds(destination, mTransform));
+  command.bitmap = &bitmap;
+  command.source = src;
+  command.opacity = opacity;
+  command.interpolation = interpolation;
+  mCommands.push_back(command);
+}
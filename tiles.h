@@ -0,0 +1,101 @@
+#pragma once
+
+#include "blit.h"
+#include "raster.h"
+#include "threadpool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// A tile based CPU renderer that draws a frame with multiple threads.
+//
+// TileRenderer records the drawing commands of a frame with an API similar to
+// the Direct2D device context. Vector geometry is flattened and stroked once
+// when the command is recorded, while the actual rasterization is deferred to
+// the end of the frame. At that point the commands are binned into the screen
+// tiles (TILE_SIZE x TILE_SIZE pixels) they touch and the tiles are rendered
+// in parallel with a work-stealing thread pool.
+//
+// Each tile executes its commands in the order they were recorded, so the
+// painter's order is preserved. As tiles never share any pixels and only the
+// tile itself affects its pixels, the output is identical regardless of the
+// number of threads or the order in which the tiles are processed.
+//
+// Bitmaps passed to drawBitmap are referenced and not copied, so they must be
+// kept alive until the endDraw has finished.
+// ============================================================================
+class TileRenderer
+{
+public:
+  static constexpr int TILE_SIZE = 64;
+
+  // create a renderer with the given amount of threads (0 = all hardware).
+  TileRenderer(int width, int height, unsigned threads = 0);
+
+  int width() const { return mWidth; }
+  int height() const { return mHeight; }
+  unsigned threadCount() const { return mPool->size(); }
+  void setThreadCount(unsigned threads);
+
+  void beginDraw();
+  void endDraw(Bitmap& target);
+
+  void setTransform(const Matrix& transform) { mTransform = transform; }
+  const Matrix& getTransform() const { return mTransform; }
+
+  void clear(const Color& color);
+  void fillRectangle(const RectF& rect, const Color& color);
+  void drawRectangle(const RectF& rect, const Color& color, float strokeWidth);
+  void fillPath(const Path& path, const Color& color,
+    FillRule rule = FillRule::NonZero);
+  void drawPath(const Path& path, const Color& color, const StrokeStyle& style);
+  void drawBitmap(const Bitmap& bitmap, const RectF& destination,
+    float opacity = 1.f,
+    Interpolation interpolation = Interpolation::Linear,
+    const RectF* source = nullptr);
+
+private:
+  enum class CommandType { Clear, Fill, Bitmap };
+
+  struct Command
+  {
+    CommandType type;
+    IntRect bounds;
+    uint32_t pixel;
+    FillRule rule;
+    size_t outline;
+    const Bitmap* bitmap;
+    RectF source;
+    Matrix inverse;
+    float opacity;
+    Interpolation interpolation;
+  };
+
+  // per worker state, so that the workers never share any mutable data.
+  struct Scratch
+  {
+    Rasterizer rasterizer{ TILE_SIZE, TILE_SIZE };
+    CoverageMask mask;
+  };
+
+  Outline& nextOutline();
+  void addOutlineCommand(const Color& color, FillRule rule);
+  void renderTile(size_t tile, unsigned worker, Bitmap& target);
+
+  int mWidth;
+  int mHeight;
+  int mColumns;
+  int mRows;
+  Matrix mTransform;
+  Path mPath;
+
+  std::unique_ptr<ThreadPool> mPool;
+  std::vector<Scratch> mScratch;
+
+  std::vector<Command> mCommands;
+  std::vector<Outline> mOutlines;
+  size_t mOutlineCount = 0;
+  std::vector<std::vector<uint32_t>> mBins;
+};